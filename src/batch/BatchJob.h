@@ -0,0 +1,31 @@
+#ifndef GBTEST_BATCHJOB_H
+#define GBTEST_BATCHJOB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gbtest {
+
+struct BatchJob {
+    std::string romPath;
+    uint64_t frameCount;            // Frames worth of cycles to run
+    std::string inputScriptPath;    // Buttons to press (see InputScript), none if empty
+    std::string hashOutputPath;     // File to write the hash of every completed frame to, none if empty
+}; // struct BatchJob
+
+struct BatchJobResult {
+    bool success;
+    std::string error;          // Why the job failed
+
+    uint64_t cycleCount;
+    uint64_t completedFrameCount;
+    uint64_t lastFrameHash;     // FNV-1a hash of the last completed frame
+    double seconds;
+
+    size_t memoryFootprint;     // Bytes owned by the instance, the mapped ROM excepted
+}; // struct BatchJobResult
+
+} // namespace gbtest
+
+#endif //GBTEST_BATCHJOB_H
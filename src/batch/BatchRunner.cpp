@@ -0,0 +1,143 @@
+#include "BatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "InputScript.h"
+#include "WorkStealingPool.h"
+
+#include "../platform/GameBoy.h"
+
+namespace {
+
+constexpr uint64_t s_cyclesPerFrame = 70224; // 154 lines of 456 cycles
+
+uint64_t hashFrame(const gbtest::Framebuffer::FramebufferContainer& framebuffer)
+{
+    // FNV-1a, 64 bits
+    uint64_t hash = 0xCBF29CE484222325;
+
+    for (const uint32_t pixel: framebuffer) {
+        hash = (hash ^ pixel) * 0x100000001B3;
+    }
+
+    return hash;
+}
+
+gbtest::BatchJobResult makeFailedResult(std::string error)
+{
+    gbtest::BatchJobResult result = {};
+    result.success = false;
+    result.error = std::move(error);
+
+    return result;
+}
+
+} // namespace
+
+gbtest::BatchRunner::BatchRunner(unsigned threadCount)
+        : m_threadCount(std::max(threadCount, 1u))
+{
+
+}
+
+std::vector<gbtest::BatchJobResult> gbtest::BatchRunner::run(const std::vector<BatchJob>& jobs) const
+{
+    std::vector<BatchJobResult> results(jobs.size());
+
+    // Each task only writes its own result
+    WorkStealingPool pool(std::min<unsigned>(m_threadCount, std::max<size_t>(jobs.size(), 1)));
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        pool.submit([&jobs, &results, i]() -> void {
+            results[i] = runJob(jobs[i]);
+        });
+    }
+
+    pool.wait();
+
+    return results;
+}
+
+gbtest::BatchJobResult gbtest::BatchRunner::runJob(const BatchJob& job)
+{
+    // On the heap, the instance is too large for some platforms' default thread stack size
+    const std::unique_ptr<GameBoy> gameboy = std::make_unique<GameBoy>();
+    gameboy->init();
+
+    const CartridgeLoadStatus loadStatus = gameboy->loadCartridge(job.romPath);
+    if (loadStatus != CartridgeLoadStatus::Success) {
+        return makeFailedResult(Cartridge::getLoadStatusDescription(loadStatus));
+    }
+
+    InputScript inputScript;
+    if (!job.inputScriptPath.empty() && !inputScript.load(job.inputScriptPath)) {
+        return makeFailedResult("Can't read the input script " + job.inputScriptPath);
+    }
+
+    // Hash the frames as they complete, they're only written out once the job is done
+    std::vector<uint64_t> frameHashes;
+    uint64_t lastFrameHash = 0;
+    uint64_t completedFrameCount = 0;
+    const bool keepFrameHashes = !job.hashOutputPath.empty();
+
+    if (keepFrameHashes) {
+        frameHashes.reserve(job.frameCount);
+    }
+
+    gameboy->getPpu().getFramebuffer().setFramebufferReadyCallback(
+            [&](const Framebuffer::FramebufferContainer& framebuffer) -> void {
+                lastFrameHash = hashFrame(framebuffer);
+                ++completedFrameCount;
+
+                if (keepFrameHashes) {
+                    frameHashes.push_back(lastFrameHash);
+                }
+            });
+
+    // Run frame by frame, the input script can only change the buttons in between
+    const auto startTime = std::chrono::steady_clock::now();
+    uint64_t cycleCount = 0;
+
+    for (uint64_t frame = 0; frame < job.frameCount; ++frame) {
+        gameboy->getJoypad().setPressedButtons(inputScript.getPressedButtons(frame));
+
+        const uint64_t frameCycleCount = gameboy->runCycles(s_cyclesPerFrame);
+        cycleCount += frameCycleCount;
+
+        // Stop early if the bus trapped
+        if (frameCycleCount < s_cyclesPerFrame) { break; }
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+
+    if (keepFrameHashes) {
+        FILE* hashFile = fopen(job.hashOutputPath.c_str(), "w");
+        if (hashFile == nullptr) {
+            return makeFailedResult("Can't write the frame hashes to " + job.hashOutputPath);
+        }
+
+        for (size_t i = 0; i < frameHashes.size(); ++i) {
+            fprintf(hashFile, "%zu %016llx\n", i, static_cast<unsigned long long>(frameHashes[i]));
+        }
+
+        fclose(hashFile);
+    }
+
+    BatchJobResult result = {};
+    result.success = true;
+    result.cycleCount = cycleCount;
+    result.completedFrameCount = completedFrameCount;
+    result.lastFrameHash = lastFrameHash;
+    result.seconds = std::chrono::duration<double>(endTime - startTime).count();
+    result.memoryFootprint = gameboy->getMemoryFootprint() + frameHashes.capacity() * sizeof(uint64_t);
+
+    return result;
+}
+
+unsigned gbtest::BatchRunner::getThreadCount() const
+{
+    return m_threadCount;
+}
@@ -0,0 +1,28 @@
+#ifndef GBTEST_BATCHRUNNER_H
+#define GBTEST_BATCHRUNNER_H
+
+#include <vector>
+
+#include "BatchJob.h"
+
+namespace gbtest {
+
+// Runs independent jobs on their own Game Boy instance, as many at once as there are threads
+class BatchRunner {
+
+public:
+    explicit BatchRunner(unsigned threadCount);
+
+    [[nodiscard]] std::vector<BatchJobResult> run(const std::vector<BatchJob>& jobs) const;
+    [[nodiscard]] static BatchJobResult runJob(const BatchJob& job);
+
+    [[nodiscard]] unsigned getThreadCount() const;
+
+private:
+    unsigned m_threadCount;
+
+}; // class BatchRunner
+
+} // namespace gbtest
+
+#endif //GBTEST_BATCHRUNNER_H
@@ -0,0 +1,94 @@
+#include "InputScript.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "../joypad/JoypadButton.h"
+
+bool gbtest::InputScript::load(const std::string& path)
+{
+    std::ifstream scriptFile(path);
+    if (!scriptFile) { return false; }
+
+    m_inputEvents.clear();
+
+    std::string line;
+    while (std::getline(scriptFile, line)) {
+        std::istringstream lineStream(line);
+
+        // Skip empty lines and comments
+        std::string frameText;
+        if (!(lineStream >> frameText) || frameText[0] == '#') { continue; }
+
+        std::string buttonNames;
+        InputEvent inputEvent = {};
+
+        if (!(lineStream >> buttonNames) || !parseButtons(buttonNames, inputEvent.pressedButtons)) {
+            return false;
+        }
+
+        char* frameTextEnd = nullptr;
+        inputEvent.frame = std::strtoull(frameText.c_str(), &frameTextEnd, 10);
+        if (*frameTextEnd != '\0') { return false; }
+
+        m_inputEvents.push_back(inputEvent);
+    }
+
+    // A later line wins over an earlier one for the same frame
+    std::stable_sort(m_inputEvents.begin(), m_inputEvents.end(),
+            [](const InputEvent& first, const InputEvent& second) -> bool {
+                return first.frame < second.frame;
+            });
+
+    return true;
+}
+
+uint8_t gbtest::InputScript::getPressedButtons(uint64_t frame) const
+{
+    // Find the last event at or before this frame
+    const auto nextEvent = std::upper_bound(m_inputEvents.begin(), m_inputEvents.end(), frame,
+            [](uint64_t frame, const InputEvent& inputEvent) -> bool {
+                return frame < inputEvent.frame;
+            });
+
+    return (nextEvent == m_inputEvents.begin()) ? 0x00 : std::prev(nextEvent)->pressedButtons;
+}
+
+bool gbtest::InputScript::parseButtons(const std::string& buttonNames, uint8_t& pressedButtons)
+{
+    static constexpr struct {
+        const char* name;
+        JoypadButton button;
+    } s_buttons[] = {
+            {"Right",  JoypadButton::Right},
+            {"Left",   JoypadButton::Left},
+            {"Up",     JoypadButton::Up},
+            {"Down",   JoypadButton::Down},
+            {"A",      JoypadButton::A},
+            {"B",      JoypadButton::B},
+            {"Select", JoypadButton::Select},
+            {"Start",  JoypadButton::Start},
+    };
+
+    pressedButtons = 0x00;
+    if (buttonNames == "-") { return true; }
+
+    std::istringstream namesStream(buttonNames);
+    std::string buttonName;
+
+    while (std::getline(namesStream, buttonName, '+')) {
+        const auto button = std::find_if(std::begin(s_buttons), std::end(s_buttons),
+                [&](const auto& namedButton) -> bool {
+                    return buttonName == namedButton.name;
+                });
+
+        if (button == std::end(s_buttons)) { return false; }
+
+        pressedButtons |= static_cast<uint8_t>(button->button);
+    }
+
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef GBTEST_INPUTSCRIPT_H
+#define GBTEST_INPUTSCRIPT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gbtest {
+
+/*
+ * Buttons to hold, frame by frame
+ * Each line of the script file gives a frame and the buttons pressed from that frame on, joined with '+'
+ * (Right, Left, Up, Down, A, B, Select, Start, or '-' for none), lines starting with '#' are ignored
+ */
+class InputScript {
+
+public:
+    InputScript() = default;
+
+    bool load(const std::string& path);
+
+    [[nodiscard]] uint8_t getPressedButtons(uint64_t frame) const;
+
+private:
+    struct InputEvent {
+        uint64_t frame;
+        uint8_t pressedButtons;
+    }; // struct InputEvent
+
+    std::vector<InputEvent> m_inputEvents; // Sorted by frame
+
+    [[nodiscard]] static bool parseButtons(const std::string& buttonNames, uint8_t& pressedButtons);
+
+}; // class InputScript
+
+} // namespace gbtest
+
+#endif //GBTEST_INPUTSCRIPT_H
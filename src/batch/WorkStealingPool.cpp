@@ -0,0 +1,121 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+gbtest::WorkStealingPool::WorkStealingPool(unsigned threadCount)
+        : m_nextQueueIdx(0)
+        , m_queuedTaskCount(0)
+        , m_pendingTaskCount(0)
+        , m_stopping(false)
+{
+    threadCount = std::max(threadCount, 1u);
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_taskQueues.push_back(std::make_unique<TaskQueue>());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&WorkStealingPool::runWorker, this, i);
+    }
+}
+
+gbtest::WorkStealingPool::~WorkStealingPool()
+{
+    // Let the workers finish the queued tasks, then stop
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_taskCondition.notify_all();
+
+    for (std::thread& worker: m_workers) {
+        worker.join();
+    }
+}
+
+void gbtest::WorkStealingPool::submit(Task&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queuedTaskCount;
+        ++m_pendingTaskCount;
+    }
+
+    // Spread the tasks over the queues
+    TaskQueue& taskQueue = *m_taskQueues[m_nextQueueIdx];
+    m_nextQueueIdx = (m_nextQueueIdx + 1) % m_taskQueues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(taskQueue.mutex);
+        taskQueue.tasks.push_back(std::move(task));
+    }
+
+    m_taskCondition.notify_one();
+}
+
+void gbtest::WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() -> bool { return m_pendingTaskCount == 0; });
+}
+
+unsigned gbtest::WorkStealingPool::getThreadCount() const
+{
+    return static_cast<unsigned>(m_workers.size());
+}
+
+void gbtest::WorkStealingPool::runWorker(size_t workerIdx)
+{
+    while (true) {
+        Task task;
+
+        if (takeTask(workerIdx, task)) {
+            task();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pendingTaskCount == 0) {
+                m_idleCondition.notify_all();
+            }
+
+            continue;
+        }
+
+        // Sleep until there is something to take (it may briefly be counted before being in a queue)
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_taskCondition.wait(lock, [this]() -> bool { return m_stopping || m_queuedTaskCount > 0; });
+
+        if (m_stopping && m_queuedTaskCount == 0) { return; }
+    }
+}
+
+bool gbtest::WorkStealingPool::takeTask(size_t workerIdx, Task& task)
+{
+    const size_t queueCount = m_taskQueues.size();
+
+    // Own queue first (newest task), then the others (oldest task)
+    for (size_t i = 0; i < queueCount; ++i) {
+        TaskQueue& taskQueue = *m_taskQueues[(workerIdx + i) % queueCount];
+        std::unique_lock<std::mutex> queueLock(taskQueue.mutex);
+
+        if (taskQueue.tasks.empty()) { continue; }
+
+        if (i == 0) {
+            task = std::move(taskQueue.tasks.back());
+            taskQueue.tasks.pop_back();
+        }
+        else {
+            task = std::move(taskQueue.tasks.front());
+            taskQueue.tasks.pop_front();
+        }
+
+        queueLock.unlock();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_queuedTaskCount;
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,62 @@
+#ifndef GBTEST_WORKSTEALINGPOOL_H
+#define GBTEST_WORKSTEALINGPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gbtest {
+
+/*
+ * Thread pool with one task queue per worker
+ * Tasks are spread over the queues, each worker takes from the back of its own queue,
+ * and steals from the front of the others once it is empty
+ */
+class WorkStealingPool {
+
+public:
+    using Task = std::function<void()>;
+
+public:
+    explicit WorkStealingPool(unsigned threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task&& task);
+    void wait(); // Until every submitted task has run
+
+    [[nodiscard]] unsigned getThreadCount() const;
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    }; // struct TaskQueue
+
+    std::vector<std::unique_ptr<TaskQueue>> m_taskQueues;
+    std::vector<std::thread> m_workers;
+    size_t m_nextQueueIdx; // Queue the next submitted task goes to
+
+    // Guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_taskCondition;
+    std::condition_variable m_idleCondition;
+    size_t m_queuedTaskCount;   // Tasks in the queues (counted before they're pushed, so it never goes negative)
+    size_t m_pendingTaskCount;  // Tasks queued or running
+    bool m_stopping;
+
+    void runWorker(size_t workerIdx);
+    bool takeTask(size_t workerIdx, Task& task);
+
+}; // class WorkStealingPool
+
+} // namespace gbtest
+
+#endif //GBTEST_WORKSTEALINGPOOL_H
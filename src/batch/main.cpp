@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchRunner.h"
+
+static void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " <job list> [options]" << std::endl
+              << "  --threads <n>       Number of instances run at once (default: one per core)" << std::endl
+              << std::endl
+              << "Each line of the job list is a job, '#' starts a comment:" << std::endl
+              << "  <rom> <frames> [<input script>|-] [<frame hashes output>|-]" << std::endl;
+}
+
+static bool loadJobList(const char* jobListPath, std::vector<gbtest::BatchJob>& jobs)
+{
+    std::ifstream jobListFile(jobListPath);
+    if (!jobListFile) { return false; }
+
+    std::string line;
+    unsigned lineNumber = 0;
+
+    while (std::getline(jobListFile, line)) {
+        ++lineNumber;
+
+        std::istringstream lineStream(line);
+        gbtest::BatchJob job = {};
+
+        // Skip empty lines and comments
+        if (!(lineStream >> job.romPath) || job.romPath[0] == '#') { continue; }
+
+        if (!(lineStream >> job.frameCount)) {
+            std::cerr << jobListPath << ":" << lineNumber << ": missing frame count" << std::endl;
+            return false;
+        }
+
+        // Optional paths, '-' to skip one
+        lineStream >> job.inputScriptPath >> job.hashOutputPath;
+
+        if (job.inputScriptPath == "-") { job.inputScriptPath.clear(); }
+        if (job.hashOutputPath == "-") { job.hashOutputPath.clear(); }
+
+        jobs.push_back(std::move(job));
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* jobListPath = nullptr;
+    unsigned threadCount = std::thread::hardware_concurrency();
+
+    // Parse the command line
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = (i + 1 < argc);
+
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threadCount = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argv[i][0] != '-' && jobListPath == nullptr) {
+            jobListPath = argv[i];
+        }
+        else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (jobListPath == nullptr) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<gbtest::BatchJob> jobs;
+    if (!loadJobList(jobListPath, jobs)) {
+        std::cerr << "Couldn't read the job list " << jobListPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Run every job
+    const gbtest::BatchRunner batchRunner(threadCount);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const std::vector<gbtest::BatchJobResult> results = batchRunner.run(jobs);
+    const auto endTime = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    // Report each job, then the whole batch
+    uint64_t totalFrameCount = 0;
+    size_t maxMemoryFootprint = 0;
+    unsigned failedJobCount = 0;
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const gbtest::BatchJobResult& result = results[i];
+
+        if (!result.success) {
+            printf("job %zu: %s: error: %s\n", i, jobs[i].romPath.c_str(), result.error.c_str());
+            ++failedJobCount;
+
+            continue;
+        }
+
+        const uint64_t frameCount = result.cycleCount / 70224;
+        totalFrameCount += frameCount;
+        maxMemoryFootprint = std::max(maxMemoryFootprint, result.memoryFootprint);
+
+        printf("job %zu: %s: frames: %llu (%llu drawn), last frame hash: %016llx, time: %.3f s, frames/s: %.1f, "
+               "memory: %zu KiB\n",
+                i, jobs[i].romPath.c_str(), static_cast<unsigned long long>(frameCount),
+                static_cast<unsigned long long>(result.completedFrameCount),
+                static_cast<unsigned long long>(result.lastFrameHash), result.seconds,
+                static_cast<double>(frameCount) / result.seconds, result.memoryFootprint / 1024);
+    }
+
+    printf("jobs: %zu (%u failed)\n", jobs.size(), failedJobCount);
+    printf("threads: %u\n", batchRunner.getThreadCount());
+    printf("frames: %llu\n", static_cast<unsigned long long>(totalFrameCount));
+    printf("time: %.3f s\n", seconds);
+    printf("frames/s: %.1f\n", static_cast<double>(totalFrameCount) / seconds);
+    printf("memory per instance: %zu KiB (ROM mappings are shared)\n", maxMemoryFootprint / 1024);
+
+    return (failedJobCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <ctime>
+
+#include "BenchmarkRunner.h"
+
+#include "../ppu/TileDecoder.h"
+
+gbtest::bench::BenchmarkState::BenchmarkState(std::string name, double minSeconds, unsigned repetitions)
+        : m_result{std::move(name), 0, 0, 0, 1, "items"}
+        , m_minSeconds(minSeconds)
+        , m_repetitions(std::max(repetitions, 1u))
+{
+
+}
+
+const gbtest::bench::BenchmarkResult& gbtest::bench::BenchmarkState::getResult() const
+{
+    return m_result;
+}
+
+void gbtest::bench::BenchmarkState::recordSamples(uint64_t iterations, std::vector<double>& samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    m_result.iterations = iterations;
+    m_result.bestNanoseconds = samples.front();
+    m_result.medianNanoseconds = samples[samples.size() / 2];
+}
+
+gbtest::bench::BenchmarkRunner::BenchmarkRunner(double minSeconds, unsigned repetitions)
+        : m_minSeconds(minSeconds)
+        , m_repetitions(repetitions)
+{
+
+}
+
+void gbtest::bench::BenchmarkRunner::addBenchmark(std::string name, BenchmarkFunction&& benchmarkFunction)
+{
+    m_benchmarks.emplace_back(std::move(name), std::move(benchmarkFunction));
+}
+
+void gbtest::bench::BenchmarkRunner::run(const std::string& filter, std::ostream& log)
+{
+    char line[160];
+
+    snprintf(line, sizeof(line), "%-40s %14s %14s %12s %20s\n", "Benchmark", "Best (ns)", "Median (ns)", "Iterations",
+            "Throughput");
+    log << line;
+
+    for (auto& [name, benchmarkFunction]: m_benchmarks) {
+        if (name.find(filter) == std::string::npos) { continue; }
+
+        BenchmarkState state(name, m_minSeconds, m_repetitions);
+        benchmarkFunction(state);
+
+        const BenchmarkResult& result = state.getResult();
+        const double itemsPerSecond = result.itemsPerIteration * 1e9 / result.bestNanoseconds;
+
+        snprintf(line, sizeof(line), "%-40s %14.1f %14.1f %12llu %12.4g %s/s\n", result.name.c_str(),
+                result.bestNanoseconds, result.medianNanoseconds, static_cast<unsigned long long>(result.iterations),
+                itemsPerSecond, result.itemLabel.c_str());
+        log << line << std::flush;
+
+        m_results.push_back(result);
+    }
+}
+
+void gbtest::bench::BenchmarkRunner::writeJson(std::ostream& out) const
+{
+    // Same layout as Google Benchmark's JSON output, so existing comparison tools can read it
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\",\n"
+#else
+        << "    \"library_build_type\": \"debug\",\n"
+#endif
+        << "    \"tile_decoder\": \"" << TileDecoder::getImplementationName() << "\",\n"
+        << "    \"repetitions\": " << m_repetitions << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const BenchmarkResult& result = m_results[i];
+
+        // Benchmark names only contain [A-Za-z0-9/_], nothing to escape
+        out << (i > 0 ? ",\n" : "\n")
+            << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << result.bestNanoseconds << ",\n"
+            << "      \"cpu_time\": " << result.bestNanoseconds << ",\n"
+            << "      \"median_time\": " << result.medianNanoseconds << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"items_per_second\": " << (result.itemsPerIteration * 1e9 / result.bestNanoseconds) << ",\n"
+            << "      \"item_label\": \"" << result.itemLabel << "\"\n"
+            << "    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
@@ -0,0 +1,125 @@
+#ifndef GBTEST_BENCHMARKRUNNER_H
+#define GBTEST_BENCHMARKRUNNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gbtest::bench {
+
+// Keeps the compiler from optimizing away a value computed by a benchmark
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T s_sink;
+    s_sink = value;
+#endif
+}
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;            // Iterations per repetition
+    double bestNanoseconds;         // Best time per iteration over all repetitions
+    double medianNanoseconds;       // Median time per iteration over all repetitions
+    double itemsPerIteration;       // Work done by one iteration (cycles, accesses, scanlines, frames...)
+    std::string itemLabel;
+}; // struct BenchmarkResult
+
+class BenchmarkState {
+
+public:
+    BenchmarkState(std::string name, double minSeconds, unsigned repetitions);
+
+    /*
+     * Time the body: the iteration count is doubled until one repetition lasts at least the minimum time,
+     * then the body is run that many times for every repetition
+     * Everything done before calling measure() is setup, and isn't timed
+     */
+    template<typename Body>
+    void measure(double itemsPerIteration, const char* itemLabel, Body&& body);
+
+    [[nodiscard]] const BenchmarkResult& getResult() const;
+
+private:
+    BenchmarkResult m_result;
+    double m_minSeconds;
+    unsigned m_repetitions;
+
+    template<typename Body>
+    static double timeIterations(uint64_t iterations, Body& body);
+
+    void recordSamples(uint64_t iterations, std::vector<double>& samples);
+
+}; // class BenchmarkState
+
+class BenchmarkRunner {
+
+public:
+    using BenchmarkFunction = std::function<void(BenchmarkState& state)>;
+
+    BenchmarkRunner(double minSeconds, unsigned repetitions);
+
+    void addBenchmark(std::string name, BenchmarkFunction&& benchmarkFunction);
+
+    // Run the benchmarks whose name contains the filter, printing each result as it is measured
+    void run(const std::string& filter, std::ostream& log);
+
+    void writeJson(std::ostream& out) const;
+
+private:
+    double m_minSeconds;
+    unsigned m_repetitions;
+
+    std::vector<std::pair<std::string, BenchmarkFunction>> m_benchmarks;
+    std::vector<BenchmarkResult> m_results;
+
+}; // class BenchmarkRunner
+
+} // namespace gbtest::bench
+
+template<typename Body>
+void gbtest::bench::BenchmarkState::measure(double itemsPerIteration, const char* itemLabel, Body&& body)
+{
+    m_result.itemsPerIteration = itemsPerIteration;
+    m_result.itemLabel = itemLabel;
+
+    // Calibrate, without growing by more than 100x at once in case the first runs were too short to be timed
+    uint64_t iterations = 1;
+
+    for (double seconds = timeIterations(iterations, body); seconds < m_minSeconds;
+            seconds = timeIterations(iterations, body)) {
+        const double scale = std::clamp(1.2 * m_minSeconds / std::max(seconds, 1e-9), 2.0, 100.0);
+        iterations = static_cast<uint64_t>(static_cast<double>(iterations) * scale);
+    }
+
+    // Measure
+    std::vector<double> samples;
+
+    for (unsigned repetition = 0; repetition < m_repetitions; ++repetition) {
+        samples.push_back(timeIterations(iterations, body) * 1e9 / static_cast<double>(iterations));
+    }
+
+    recordSamples(iterations, samples);
+}
+
+template<typename Body>
+double gbtest::bench::BenchmarkState::timeIterations(uint64_t iterations, Body& body)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body();
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+#endif //GBTEST_BENCHMARKRUNNER_H
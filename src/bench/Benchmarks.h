@@ -0,0 +1,15 @@
+#ifndef GBTEST_BENCHMARKS_H
+#define GBTEST_BENCHMARKS_H
+
+#include "BenchmarkRunner.h"
+
+namespace gbtest::bench {
+
+void registerCpuBenchmarks(BenchmarkRunner& runner);
+void registerBusBenchmarks(BenchmarkRunner& runner);
+void registerPpuBenchmarks(BenchmarkRunner& runner);
+void registerGameBoyBenchmarks(BenchmarkRunner& runner);
+
+} // namespace gbtest::bench
+
+#endif //GBTEST_BENCHMARKS_H
@@ -0,0 +1,61 @@
+#include "Benchmarks.h"
+
+#include "../platform/GameBoy.h"
+
+struct BusRegion {
+    const char* name;
+    uint16_t firstAddr;
+    uint16_t size;      // Accesses wrap around within the region
+}; // struct BusRegion
+
+static constexpr BusRegion s_busRegions[] = {
+        {"ROM", 0x0000, 0x8000},
+        {"VRAM", 0x8000, 0x2000},
+        {"WRAM", 0xC000, 0x2000},
+        {"OAM", 0xFE00, 0x00A0},
+        {"PPURegisters", 0xFF42, 0x0002}, // SCY and SCX, the other registers have side effects
+        {"HRAM", 0xFF80, 0x007F},
+};
+
+static void setUpBusBenchmark(gbtest::GameBoy& gameboy)
+{
+    gameboy.init();
+
+    // Turn the LCD off so that VRAM and OAM aren't locked
+    gameboy.getBus().write(0xFF40, 0x00, gbtest::BusRequestSource::Privileged);
+}
+
+void gbtest::bench::registerBusBenchmarks(BenchmarkRunner& runner)
+{
+    for (const BusRegion& region: s_busRegions) {
+        runner.addBenchmark(std::string("Bus/Read/") + region.name, [region](BenchmarkState& state) -> void {
+            GameBoy gameboy;
+            setUpBusBenchmark(gameboy);
+
+            const Bus& bus = gameboy.getBus();
+
+            state.measure(256, "accesses", [&]() -> void {
+                uint8_t sum = 0;
+
+                for (unsigned i = 0; i < 256; ++i) {
+                    sum += bus.read(region.firstAddr + ((i * 7) % region.size), BusRequestSource::CPU);
+                }
+
+                doNotOptimize(sum);
+            });
+        });
+
+        runner.addBenchmark(std::string("Bus/Write/") + region.name, [region](BenchmarkState& state) -> void {
+            GameBoy gameboy;
+            setUpBusBenchmark(gameboy);
+
+            Bus& bus = gameboy.getBus();
+
+            state.measure(256, "accesses", [&]() -> void {
+                for (unsigned i = 0; i < 256; ++i) {
+                    bus.write(region.firstAddr + ((i * 7) % region.size), i, BusRequestSource::CPU);
+                }
+            });
+        });
+    }
+}
@@ -0,0 +1,128 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmarks.h"
+
+#include "../platform/GameBoy.h"
+
+// Synthetic programs, all looping forever from 0100h
+static const std::vector<uint8_t> s_aluLoop = {
+        0x80,       // 0100h: ADD A, B
+        0xA9,       // 0101h: XOR C
+        0x14,       // 0102h: INC D
+        0xA3,       // 0103h: AND E
+        0xB4,       // 0104h: OR H
+        0x95,       // 0105h: SUB L
+        0x05,       // 0106h: DEC B
+        0x89,       // 0107h: ADC A, C
+        0x18, 0xF6, // 0108h: JR 0100h
+};
+
+static const std::vector<uint8_t> s_loadStoreLoop = {
+        0x21, 0x00, 0xC0,   // 0100h: LD HL, C000h
+        0x7E,               // 0103h: LD A, (HL)
+        0x77,               // 0104h: LD (HL), A
+        0x46,               // 0105h: LD B, (HL)
+        0x70,               // 0106h: LD (HL), B
+        0xFA, 0x00, 0xC1,   // 0107h: LD A, (C100h)
+        0xEA, 0x01, 0xC1,   // 010Ah: LD (C101h), A
+        0xF0, 0x80,         // 010Dh: LDH A, (FF80h)
+        0xE0, 0x81,         // 010Fh: LDH (FF81h), A
+        0x2C,               // 0111h: INC L (stays in C0xxh)
+        0x18, 0xEF,         // 0112h: JR 0103h
+};
+
+static const std::vector<uint8_t> s_branchLoop = {
+        0x05,               // 0100h: DEC B
+        0x20, 0xFD,         // 0101h: JR NZ, 0100h
+        0xCD, 0x0A, 0x01,   // 0103h: CALL 010Ah
+        0xC3, 0x00, 0x01,   // 0106h: JP 0100h
+        0x00,               // 0109h: NOP
+        0xC9,               // 010Ah: RET
+};
+
+static const std::vector<uint8_t> s_bitOpsLoop = {
+        0xCB, 0x00, // 0100h: RLC B
+        0xCB, 0x19, // 0102h: RR C
+        0xCB, 0x22, // 0104h: SLA D
+        0xCB, 0x33, // 0106h: SWAP E
+        0xCB, 0x7C, // 0108h: BIT 7, H
+        0xCB, 0x85, // 010Ah: RES 0, L
+        0xCB, 0xEF, // 010Ch: SET 5, A
+        0xCB, 0x3F, // 010Eh: SRL A
+        0x18, 0xEE, // 0110h: JR 0100h
+};
+
+// How the CPU is driven
+enum class CpuRunMode {
+    Tick,       // One cycle at a time
+    RunFor,     // Whole instructions
+    BlockCache, // Decoded blocks
+    Jit,        // Compiled blocks
+}; // enum class CpuRunMode
+
+static void benchmarkCpuProgram(gbtest::bench::BenchmarkState& state, const std::vector<uint8_t>& program,
+        CpuRunMode runMode)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+
+    // Turn the LCD off so that only the CPU runs
+    gameboy.getBus().write(0xFF40, 0x00, gbtest::BusRequestSource::Privileged);
+
+    for (size_t i = 0; i < program.size(); ++i) {
+        gameboy.getBus().write(0x100 + i, program[i], gbtest::BusRequestSource::Privileged);
+    }
+
+    gbtest::LR35902& cpu = gameboy.getCpu();
+    cpu.setBlockCacheEnabled(runMode == CpuRunMode::BlockCache);
+
+#ifdef GBTEST_CPU_JIT
+    cpu.setJitEnabled(runMode == CpuRunMode::Jit);
+#endif
+
+    if (runMode != CpuRunMode::Tick) {
+        // Nothing is scheduled while the LCD is off, so the CPU never has to stop early
+        state.measure(1000, "cycles", [&]() -> void {
+            cpu.runFor(1000);
+        });
+    }
+    else {
+        state.measure(1000, "cycles", [&]() -> void {
+            for (unsigned i = 0; i < 1000; ++i) {
+                cpu.tick();
+            }
+        });
+    }
+}
+
+void gbtest::bench::registerCpuBenchmarks(BenchmarkRunner& runner)
+{
+    const std::pair<const char*, const std::vector<uint8_t>*> programs[] = {
+            {"ALU", &s_aluLoop},
+            {"LoadStore", &s_loadStoreLoop},
+            {"Branch", &s_branchLoop},
+            {"BitOps", &s_bitOpsLoop},
+    };
+
+    for (const auto& [name, program]: programs) {
+        runner.addBenchmark(std::string("CPU/Tick/") + name, [program = program](BenchmarkState& state) -> void {
+            benchmarkCpuProgram(state, *program, CpuRunMode::Tick);
+        });
+
+        runner.addBenchmark(std::string("CPU/RunFor/") + name, [program = program](BenchmarkState& state) -> void {
+            benchmarkCpuProgram(state, *program, CpuRunMode::RunFor);
+        });
+
+        runner.addBenchmark(std::string("CPU/BlockCache/") + name, [program = program](BenchmarkState& state) -> void {
+            benchmarkCpuProgram(state, *program, CpuRunMode::BlockCache);
+        });
+
+#ifdef GBTEST_CPU_JIT
+        runner.addBenchmark(std::string("CPU/Jit/") + name, [program = program](BenchmarkState& state) -> void {
+            benchmarkCpuProgram(state, *program, CpuRunMode::Jit);
+        });
+#endif
+    }
+}
@@ -0,0 +1,153 @@
+#include "Benchmarks.h"
+
+#include <vector>
+
+#include "../platform/GameBoy.h"
+#include "../platform/state/RewindBuffer.h"
+
+static constexpr uint64_t s_cyclesPerFrame = 70224; // 154 lines of 456 cycles
+
+static void loadScrollingProgram(gbtest::GameBoy& gameboy, bool halted = false)
+{
+    gbtest::Bus& bus = gameboy.getBus();
+
+    // Fill the background with tiles, and scroll it every frame
+    for (uint16_t addr = 0x8000; addr < 0x9C00; ++addr) {
+        bus.write(addr, static_cast<uint8_t>((addr * 37) >> 3), gbtest::BusRequestSource::Privileged);
+    }
+
+    const uint8_t program[] = {
+            0x3E, 0x01,         // 0100h: LD A, 01h
+            0xE0, 0xFF,         // 0102h: LDH (IE), A (VBlank)
+            0xFB,               // 0104h: EI
+            0x80,               // 0105h: ADD A, B
+            0xA9,               // 0106h: XOR C
+            0x14,               // 0107h: INC D
+            0x18, 0xFB,         // 0108h: JR 0105h
+    };
+
+    const uint8_t vblankHandler[] = {
+            0xF0, 0x43,         // 0040h: LDH A, (SCX)
+            0x3C,               // 0042h: INC A
+            0xE0, 0x43,         // 0043h: LDH (SCX), A
+            0xD9,               // 0045h: RETI
+    };
+
+    const uint8_t haltedLoop[] = {
+            0x76,               // 0105h: HALT
+            0x18, 0xFD,         // 0106h: JR 0105h
+    };
+
+    for (size_t i = 0; i < sizeof(program); ++i) {
+        bus.write(0x100 + i, program[i], gbtest::BusRequestSource::Privileged);
+    }
+
+    // Wait for the interrupts halted instead of running a busy loop
+    if (halted) {
+        for (size_t i = 0; i < sizeof(haltedLoop); ++i) {
+            bus.write(0x105 + i, haltedLoop[i], gbtest::BusRequestSource::Privileged);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(vblankHandler); ++i) {
+        bus.write(0x40 + i, vblankHandler[i], gbtest::BusRequestSource::Privileged);
+    }
+}
+
+static void benchmarkFrames(gbtest::bench::BenchmarkState& state, bool scanlineRendering, bool halted = false)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    gameboy.getPpu().getModeManager().setScanlineRenderingEnabled(scanlineRendering);
+    loadScrollingProgram(gameboy, halted);
+
+    state.measure(1, "frames", [&]() -> void {
+        gameboy.runCycles(s_cyclesPerFrame);
+    });
+}
+
+static void benchmarkSaveState(gbtest::bench::BenchmarkState& state)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    gameboy.runCycles(s_cyclesPerFrame / 2);
+
+    // The first save allocates the buffer, the measured ones reuse it
+    std::vector<uint8_t> saveState;
+    gameboy.saveState(saveState);
+
+    state.measure(1, "states", [&]() -> void {
+        gameboy.saveState(saveState);
+        gbtest::bench::doNotOptimize(saveState.data());
+    });
+}
+
+static void benchmarkLoadState(gbtest::bench::BenchmarkState& state)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    gameboy.runCycles(s_cyclesPerFrame / 2);
+
+    std::vector<uint8_t> saveState;
+    gameboy.saveState(saveState);
+
+    state.measure(1, "states", [&]() -> void {
+        gbtest::bench::doNotOptimize(gameboy.loadState(saveState));
+    });
+}
+
+static void benchmarkRewindFrames(gbtest::bench::BenchmarkState& state)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    loadScrollingProgram(gameboy);
+
+    // One snapshot per frame, 10 seconds, a keyframe every second
+    gbtest::RewindBuffer rewindBuffer(600, 60);
+
+    state.measure(1, "frames", [&]() -> void {
+        gameboy.runCycles(s_cyclesPerFrame);
+        rewindBuffer.push(gameboy);
+    });
+}
+
+static void benchmarkRewindRestore(gbtest::bench::BenchmarkState& state)
+{
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    loadScrollingProgram(gameboy);
+
+    gbtest::RewindBuffer rewindBuffer(600, 60);
+
+    // Stop right before a keyframe, so that the restored snapshot is the delta the furthest from its keyframe
+    for (unsigned frame = 0; frame < 59; ++frame) {
+        gameboy.runCycles(s_cyclesPerFrame);
+        rewindBuffer.push(gameboy);
+    }
+
+    state.measure(1, "snapshots", [&]() -> void {
+        rewindBuffer.rewind(gameboy);
+        rewindBuffer.push(gameboy);
+    });
+}
+
+void gbtest::bench::registerGameBoyBenchmarks(BenchmarkRunner& runner)
+{
+    runner.addBenchmark("GameBoy/Frame/FIFO", [](BenchmarkState& state) -> void {
+        benchmarkFrames(state, false);
+    });
+
+    runner.addBenchmark("GameBoy/Frame/Scanline", [](BenchmarkState& state) -> void {
+        benchmarkFrames(state, true);
+    });
+
+    runner.addBenchmark("GameBoy/Frame/Halted", [](BenchmarkState& state) -> void {
+        benchmarkFrames(state, false, true);
+    });
+
+    runner.addBenchmark("GameBoy/SaveState", benchmarkSaveState);
+    runner.addBenchmark("GameBoy/LoadState", benchmarkLoadState);
+
+    runner.addBenchmark("GameBoy/Rewind/Frame", benchmarkRewindFrames);
+    runner.addBenchmark("GameBoy/Rewind/Restore", benchmarkRewindRestore);
+}
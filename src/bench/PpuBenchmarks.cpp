@@ -0,0 +1,75 @@
+#include "Benchmarks.h"
+
+#include "../ppu/modes/DrawingPPUMode.h"
+#include "../ppu/modes/ScanlineDrawingPPUMode.h"
+#include "../ppu/TileDecoder.h"
+
+// Everything a drawing mode needs, outside of a PPU
+struct PpuBenchmarkContext {
+    gbtest::Framebuffer framebuffer;
+    gbtest::PPURegisters ppuRegisters{};
+    gbtest::VRAM vram;
+    gbtest::ColorUtils::DMGPaletteLUT paletteLut;
+
+    PpuBenchmarkContext()
+    {
+        // LCD on, background from 9800h using the tiles at 8000h
+        ppuRegisters.lcdControl.raw = 0x91;
+        ppuRegisters.dmgPalettes.bgPaletteData.raw = 0xE4;
+
+        // Fill the tiles with a pattern and the tile map with all the tiles
+        for (uint16_t addr = 0x8000; addr < 0x9800; ++addr) {
+            vram.busWrite(addr, static_cast<uint8_t>((addr * 37) >> 3), gbtest::BusRequestSource::Privileged);
+        }
+
+        for (uint16_t addr = 0x9800; addr < 0x9C00; ++addr) {
+            vram.busWrite(addr, static_cast<uint8_t>(addr), gbtest::BusRequestSource::Privileged);
+        }
+    }
+
+    // Go to the next line, so that all the lines of the frame get drawn
+    void nextScanline()
+    {
+        uint8_t& yLcdCoordinate = ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate;
+        yLcdCoordinate = (yLcdCoordinate + 1) % 144;
+    }
+}; // struct PpuBenchmarkContext
+
+template<typename DrawingMode>
+static void benchmarkDrawingMode(gbtest::bench::BenchmarkState& state)
+{
+    PpuBenchmarkContext context;
+    DrawingMode drawingMode(context.framebuffer, context.ppuRegisters, context.vram, context.paletteLut);
+
+    state.measure(1, "scanlines", [&]() -> void {
+        drawingMode.restart();
+
+        while (!drawingMode.isFullyFinished()) {
+            drawingMode.tick();
+        }
+
+        context.nextScanline();
+    });
+}
+
+void gbtest::bench::registerPpuBenchmarks(BenchmarkRunner& runner)
+{
+    runner.addBenchmark("PPU/Scanline/FIFO", [](BenchmarkState& state) -> void {
+        benchmarkDrawingMode<DrawingPPUMode>(state);
+    });
+
+    runner.addBenchmark("PPU/Scanline/Scanline", [](BenchmarkState& state) -> void {
+        benchmarkDrawingMode<ScanlineDrawingPPUMode>(state);
+    });
+
+    runner.addBenchmark("PPU/TileDecoder/TileMapRow", [](BenchmarkState& state) -> void {
+        PpuBenchmarkContext context;
+        TileDecoder::TileMapRow colorIndices{};
+        uint8_t y = 0;
+
+        state.measure(32 * 8, "pixels", [&]() -> void {
+            TileDecoder::decodeTileMapRow(context.vram, 0, 1, y++, colorIndices);
+            doNotOptimize(colorIndices);
+        });
+    });
+}
@@ -0,0 +1,72 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmarks.h"
+
+static void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " [options]" << std::endl
+              << "  --filter <text>       Only run the benchmarks whose name contains <text>" << std::endl
+              << "  --json <file>         Write the results to <file> as JSON (- for stdout)" << std::endl
+              << "  --min-time <seconds>  Minimum duration of a repetition (default: 0.1)" << std::endl
+              << "  --repetitions <n>     Repetitions of each benchmark, the best one is kept (default: 5)"
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string jsonPath;
+    double minSeconds = 0.1;
+    unsigned repetitions = 5;
+
+    // Parse the command line
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = (i + 1 < argc);
+
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            minSeconds = std::strtod(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            repetitions = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    gbtest::bench::BenchmarkRunner runner(minSeconds, repetitions);
+    gbtest::bench::registerCpuBenchmarks(runner);
+    gbtest::bench::registerBusBenchmarks(runner);
+    gbtest::bench::registerPpuBenchmarks(runner);
+    gbtest::bench::registerGameBoyBenchmarks(runner);
+
+    // Keep stdout clean when the JSON goes there
+    const bool jsonToStdout = (jsonPath == "-");
+    runner.run(filter, jsonToStdout ? std::cerr : std::cout);
+
+    if (jsonToStdout) {
+        runner.writeJson(std::cout);
+    }
+    else if (!jsonPath.empty()) {
+        std::ofstream jsonFile(jsonPath);
+        if (!jsonFile) {
+            std::cerr << "Couldn't open " << jsonPath << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        runner.writeJson(jsonFile);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,559 @@
+#include "Cartridge.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr size_t s_romBankSize = 0x4000;
+constexpr size_t s_ramBankSize = 0x2000;
+constexpr size_t s_headerEndAddress = 0x0150;
+
+constexpr uint32_t s_rtcCyclesPerSecond = 4194304;
+constexpr uint8_t s_rtcRegisterMasks[5] = {0x3F, 0x3F, 0x1F, 0xFF, 0xC1};
+
+constexpr uint16_t s_cartridgeTypeAddress = 0x0147;
+constexpr uint16_t s_ramSizeAddress = 0x0149;
+
+bool parseCartridgeType(uint8_t cartridgeType, gbtest::MBCType& mbcType)
+{
+    switch (cartridgeType) {
+    case 0x00: // ROM only
+    case 0x08: // ROM + RAM
+    case 0x09: // ROM + RAM + Battery
+        mbcType = gbtest::MBCType::None;
+        return true;
+
+    case 0x01: // MBC1
+    case 0x02: // MBC1 + RAM
+    case 0x03: // MBC1 + RAM + Battery
+        mbcType = gbtest::MBCType::MBC1;
+        return true;
+
+    case 0x0F: // MBC3 + Timer + Battery
+    case 0x10: // MBC3 + Timer + RAM + Battery
+    case 0x11: // MBC3
+    case 0x12: // MBC3 + RAM
+    case 0x13: // MBC3 + RAM + Battery
+        mbcType = gbtest::MBCType::MBC3;
+        return true;
+
+    case 0x19: // MBC5
+    case 0x1A: // MBC5 + RAM
+    case 0x1B: // MBC5 + RAM + Battery
+    case 0x1C: // MBC5 + Rumble
+    case 0x1D: // MBC5 + Rumble + RAM
+    case 0x1E: // MBC5 + Rumble + RAM + Battery
+        mbcType = gbtest::MBCType::MBC5;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+size_t getRamSize(uint8_t ramSizeCode)
+{
+    static constexpr size_t s_ramSizes[] = {0, 0x800, 0x2000, 0x8000, 0x20000, 0x10000};
+
+    return (ramSizeCode < std::size(s_ramSizes)) ? s_ramSizes[ramSizeCode] : 0;
+}
+
+} // namespace
+
+gbtest::Cartridge::Cartridge(Bus& bus)
+        : m_bus(bus)
+        , m_rom(nullptr)
+        , m_romBankCount(0)
+        , m_mbcType(MBCType::None)
+        , m_ramEnabled(false)
+        , m_romBankRegister(0)
+        , m_secondaryBankRegister(0)
+        , m_advancedBankingMode(false)
+        , m_rtcRegisters()
+        , m_rtcLatchedRegisters()
+        , m_rtcLatchValue(0xFF)
+        , m_rtcSynchronizedCycle(0)
+        , m_rtcSubsecondCycles(0)
+        , m_romBank0(nullptr)
+        , m_romBankN(nullptr)
+        , m_ramBank(nullptr)
+        , m_ramBankOffset(0)
+{
+
+}
+
+gbtest::CartridgeLoadStatus gbtest::Cartridge::load(const std::string& romPath)
+{
+    unload();
+
+    // Check that the file can be mapped and contains a header
+    if (!m_romFile.open(romPath)) {
+        return CartridgeLoadStatus::CantOpenFile;
+    }
+
+    const uint8_t* const romData = m_romFile.getData();
+    const size_t romSize = m_romFile.getSize();
+
+    if (romSize < s_headerEndAddress) {
+        m_romFile.close();
+        return CartridgeLoadStatus::InvalidRom;
+    }
+
+    MBCType mbcType;
+    if (!parseCartridgeType(romData[s_cartridgeTypeAddress], mbcType)) {
+        m_romFile.close();
+        return CartridgeLoadStatus::UnsupportedMbc;
+    }
+
+    m_mbcType = mbcType;
+    m_ramEnabled = (mbcType == MBCType::None); // Without an MBC, nothing can disable the RAM
+    m_ram.assign(getRamSize(romData[s_ramSizeAddress]), 0x00);
+    m_rtcSynchronizedCycle = m_bus.getScheduler().getCurrentCycle();
+
+    if (romSize >= 2 * s_romBankSize && (romSize % s_romBankSize) == 0) {
+        // Use the mapping directly, pages are only read from the disk when the game accesses them
+        m_rom = romData;
+        m_romBankCount = romSize / s_romBankSize;
+    }
+    else {
+        // Odd sized ROM (homebrew, test ROMs), pad it with open bus values to whole banks
+        const size_t bankCount = std::max<size_t>((romSize + s_romBankSize - 1) / s_romBankSize, 2);
+
+        m_paddedRom.assign(bankCount * s_romBankSize, 0xFF);
+        std::copy(romData, romData + romSize, m_paddedRom.begin());
+        m_romFile.close();
+
+        m_rom = m_paddedRom.data();
+        m_romBankCount = bankCount;
+    }
+
+    updateBanks();
+
+    m_bus.remapAddressRange(0x0000, 0x7FFF);
+    m_bus.remapAddressRange(0xA000, 0xBFFF);
+
+    return CartridgeLoadStatus::Success;
+}
+
+void gbtest::Cartridge::unload()
+{
+    const bool wasLoaded = isLoaded();
+
+    m_romFile.close();
+    m_paddedRom.clear();
+    m_rom = nullptr;
+    m_romBankCount = 0;
+
+    m_ram.clear();
+
+    m_mbcType = MBCType::None;
+    m_ramEnabled = false;
+    m_romBankRegister = 0;
+    m_secondaryBankRegister = 0;
+    m_advancedBankingMode = false;
+
+    m_rtcRegisters.fill(0);
+    m_rtcLatchedRegisters.fill(0);
+    m_rtcLatchValue = 0xFF;
+    m_rtcSynchronizedCycle = 0;
+    m_rtcSubsecondCycles = 0;
+
+    m_romBank0 = nullptr;
+    m_romBankN = nullptr;
+    m_ramBank = nullptr;
+    m_ramBankOffset = 0;
+
+    // Give the addresses back to the other providers
+    if (wasLoaded) {
+        m_bus.remapAddressRange(0x0000, 0x7FFF);
+        m_bus.remapAddressRange(0xA000, 0xBFFF);
+    }
+}
+
+bool gbtest::Cartridge::isLoaded() const
+{
+    return m_rom != nullptr;
+}
+
+gbtest::MBCType gbtest::Cartridge::getMbcType() const
+{
+    return m_mbcType;
+}
+
+size_t gbtest::Cartridge::getRomSize() const
+{
+    return m_romBankCount * s_romBankSize;
+}
+
+unsigned gbtest::Cartridge::getRomBankNumber() const
+{
+    if (m_romBankN == nullptr) {
+        return 1;
+    }
+
+    return static_cast<unsigned>((m_romBankN - m_rom) / s_romBankSize);
+}
+
+size_t gbtest::Cartridge::getOwnedMemorySize() const
+{
+    return m_paddedRom.size() + m_ram.size();
+}
+
+std::vector<uint8_t>& gbtest::Cartridge::getRam()
+{
+    return m_ram;
+}
+
+const std::vector<uint8_t>& gbtest::Cartridge::getRam() const
+{
+    return m_ram;
+}
+
+const char* gbtest::Cartridge::getLoadStatusDescription(CartridgeLoadStatus loadStatus)
+{
+    switch (loadStatus) {
+    case CartridgeLoadStatus::Success:
+        return "Success";
+
+    case CartridgeLoadStatus::CantOpenFile:
+        return "Can't open the ROM file";
+
+    case CartridgeLoadStatus::InvalidRom:
+        return "The ROM file has no valid header";
+
+    case CartridgeLoadStatus::UnsupportedMbc:
+        return "The cartridge type isn't supported";
+    }
+
+    return "Unknown error";
+}
+
+bool gbtest::Cartridge::busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    if (!isLoaded()) {
+        return false;
+    }
+
+    if (addr < 0x4000) {
+        val = m_romBank0[addr];
+        return true;
+    }
+    else if (addr < 0x8000) {
+        val = m_romBankN[addr - 0x4000];
+        return true;
+    }
+    else if (addr >= 0xA000 && addr < 0xC000) {
+        // Only reached when the RAM isn't mapped directly
+        if (!m_ramEnabled) {
+            val = 0xFF;
+        }
+        else if (isRtcSelected()) {
+            val = m_rtcLatchedRegisters[m_secondaryBankRegister - 0x08];
+        }
+        else if (!m_ram.empty()) {
+            val = m_ram[(m_ramBankOffset + (addr - 0xA000)) % m_ram.size()];
+        }
+        else {
+            val = 0xFF;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool gbtest::Cartridge::busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    if (!isLoaded()) {
+        return false;
+    }
+
+    if (addr < 0x8000) {
+        // The ROM is read-only, writes go to the MBC registers
+        writeRegister(addr, val);
+        return true;
+    }
+    else if (addr >= 0xA000 && addr < 0xC000) {
+        // Only reached when the RAM isn't mapped directly
+        if (!m_ramEnabled) {
+            // Writes are ignored
+        }
+        else if (isRtcSelected()) {
+            const uint8_t rtcRegisterIndex = m_secondaryBankRegister - 0x08;
+
+            // Count the time spent with the old value, writing the seconds also restarts the current second
+            synchronizeRtc();
+            m_rtcRegisters[rtcRegisterIndex] = val & s_rtcRegisterMasks[rtcRegisterIndex];
+
+            if (rtcRegisterIndex == 0) {
+                m_rtcSubsecondCycles = 0;
+            }
+        }
+        else if (!m_ram.empty()) {
+            m_ram[(m_ramBankOffset + (addr - 0xA000)) % m_ram.size()] = val;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool gbtest::Cartridge::busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    // Cartridge never overrides read requests
+    return false;
+}
+
+bool gbtest::Cartridge::busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    // Cartridge never overrides write requests
+    return false;
+}
+
+gbtest::BusMapping gbtest::Cartridge::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    if (!isLoaded()) {
+        return BusMapping(BusMappingType::Unmapped);
+    }
+
+    const BusMappingType romMappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0x0000, 0x7FFF);
+    const BusMappingType ramMappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xA000, 0xBFFF);
+
+    if (romMappingType == BusMappingType::Full) {
+        // Reads come from the current banks, writes go to busWrite to reach the MBC registers
+        if (lastAddr < 0x4000) {
+            return BusMapping(this, m_romBank0 + firstAddr);
+        }
+        else if (firstAddr >= 0x4000) {
+            return BusMapping(this, m_romBankN + (firstAddr - 0x4000));
+        }
+
+        return BusMapping(this);
+    }
+    else if (ramMappingType == BusMappingType::Full) {
+        if (m_ramBank != nullptr) {
+            uint8_t* const memory = m_ramBank + (firstAddr - 0xA000);
+            return BusMapping(this, memory, memory);
+        }
+
+        return BusMapping(this);
+    }
+    else if (romMappingType == BusMappingType::Unmapped && ramMappingType == BusMappingType::Unmapped) {
+        return BusMapping(BusMappingType::Unmapped);
+    }
+
+    return BusMapping(BusMappingType::Partial);
+}
+
+void gbtest::Cartridge::writeRegister(uint16_t addr, uint8_t val)
+{
+    switch (m_mbcType) {
+    case MBCType::None:
+        // No register, writes are ignored
+        return;
+
+    case MBCType::MBC1:
+        if (addr < 0x2000) {
+            m_ramEnabled = ((val & 0x0F) == 0x0A);
+        }
+        else if (addr < 0x4000) {
+            m_romBankRegister = (val & 0x1F);
+        }
+        else if (addr < 0x6000) {
+            m_secondaryBankRegister = (val & 0x03);
+        }
+        else {
+            m_advancedBankingMode = (val & 0x01);
+        }
+        break;
+
+    case MBCType::MBC3:
+        if (addr < 0x2000) {
+            m_ramEnabled = ((val & 0x0F) == 0x0A);
+        }
+        else if (addr < 0x4000) {
+            m_romBankRegister = (val & 0x7F);
+        }
+        else if (addr < 0x6000) {
+            m_secondaryBankRegister = val;
+        }
+        else {
+            // Writing 00h then 01h latches the clock
+            if (m_rtcLatchValue == 0x00 && val == 0x01) {
+                synchronizeRtc();
+                m_rtcLatchedRegisters = m_rtcRegisters;
+            }
+
+            m_rtcLatchValue = val;
+        }
+        break;
+
+    case MBCType::MBC5:
+        if (addr < 0x2000) {
+            m_ramEnabled = ((val & 0x0F) == 0x0A);
+        }
+        else if (addr < 0x3000) {
+            m_romBankRegister = (m_romBankRegister & 0x100) | val;
+        }
+        else if (addr < 0x4000) {
+            m_romBankRegister = (m_romBankRegister & 0x0FF) | ((val & 0x01) << 8);
+        }
+        else if (addr < 0x6000) {
+            m_secondaryBankRegister = (val & 0x0F);
+        }
+        break;
+    }
+
+    updateBanks();
+}
+
+void gbtest::Cartridge::updateBanks()
+{
+    size_t romBank0 = 0;
+    size_t romBankN = 1;
+    size_t ramBank = 0;
+
+    switch (m_mbcType) {
+    case MBCType::None:
+        break;
+
+    case MBCType::MBC1:
+        // Bank 0 is never selected for the switchable area (20h, 40h and 60h can't be selected either)
+        romBankN = (m_secondaryBankRegister << 5) | std::max<uint16_t>(m_romBankRegister, 1);
+
+        // The upper bits also apply to the fixed area and select the RAM bank in advanced banking mode
+        if (m_advancedBankingMode) {
+            romBank0 = (m_secondaryBankRegister << 5);
+            ramBank = m_secondaryBankRegister;
+        }
+        break;
+
+    case MBCType::MBC3:
+        romBankN = std::max<uint16_t>(m_romBankRegister, 1);
+        ramBank = (m_secondaryBankRegister & 0x03);
+        break;
+
+    case MBCType::MBC5:
+        // Bank 0 can be selected for the switchable area
+        romBankN = m_romBankRegister;
+        ramBank = m_secondaryBankRegister;
+        break;
+    }
+
+    // Banks past the end of the ROM (or RAM) mirror the existing ones
+    const uint8_t* const romBank0Memory = m_rom + (romBank0 % m_romBankCount) * s_romBankSize;
+    const uint8_t* const romBankNMemory = m_rom + (romBankN % m_romBankCount) * s_romBankSize;
+
+    const size_t ramBankCount = m_ram.size() / s_ramBankSize;
+    const size_t ramBankOffset = (ramBankCount > 0) ? (ramBank % ramBankCount) * s_ramBankSize : 0;
+
+    // RAMs smaller than a bank and the RTC registers are accessed through the provider
+    uint8_t* const ramBankMemory = (m_ramEnabled && ramBankCount > 0 && !isRtcSelected())
+            ? m_ram.data() + ramBankOffset : nullptr;
+
+    m_ramBankOffset = ramBankOffset;
+
+    // Swap the pointers the bus reads through, only for the areas that changed
+    if (romBank0Memory != m_romBank0) {
+        m_romBank0 = romBank0Memory;
+        m_bus.remapAddressRangeMemory(this, 0x0000, 0x3FFF, m_romBank0, nullptr);
+    }
+
+    if (romBankNMemory != m_romBankN) {
+        m_romBankN = romBankNMemory;
+        m_bus.remapAddressRangeMemory(this, 0x4000, 0x7FFF, m_romBankN, nullptr);
+    }
+
+    if (ramBankMemory != m_ramBank) {
+        m_ramBank = ramBankMemory;
+        m_bus.remapAddressRangeMemory(this, 0xA000, 0xBFFF, m_ramBank, m_ramBank);
+    }
+}
+
+bool gbtest::Cartridge::isRtcSelected() const
+{
+    return m_mbcType == MBCType::MBC3 && m_secondaryBankRegister >= 0x08 && m_secondaryBankRegister <= 0x0C;
+}
+
+void gbtest::Cartridge::synchronizeRtc()
+{
+    // Nothing ticks on its own, the time elapsed since the last access is counted when the game looks at the clock
+    const uint64_t currentCycle = m_bus.getScheduler().getCurrentCycle();
+    const uint64_t elapsedCycles = currentCycle - m_rtcSynchronizedCycle;
+
+    m_rtcSynchronizedCycle = currentCycle;
+
+    // Bit 6 of the upper day counter halts the clock
+    if ((m_rtcRegisters[4] & 0x40) != 0) {
+        return;
+    }
+
+    const uint64_t subsecondCycles = m_rtcSubsecondCycles + elapsedCycles;
+
+    m_rtcSubsecondCycles = static_cast<uint32_t>(subsecondCycles % s_rtcCyclesPerSecond);
+    advanceRtc(subsecondCycles / s_rtcCyclesPerSecond);
+}
+
+void gbtest::Cartridge::advanceRtc(uint64_t secondCount)
+{
+    if (secondCount == 0) {
+        return;
+    }
+
+    // Out of range values written by the game carry right away, instead of counting up to their register limit
+    const uint64_t seconds = m_rtcRegisters[0] + secondCount;
+    const uint64_t minutes = m_rtcRegisters[1] + (seconds / 60);
+    const uint64_t hours = m_rtcRegisters[2] + (minutes / 60);
+    const uint64_t days = (((m_rtcRegisters[4] & 0x01) << 8) | m_rtcRegisters[3]) + (hours / 24);
+
+    m_rtcRegisters[0] = seconds % 60;
+    m_rtcRegisters[1] = minutes % 60;
+    m_rtcRegisters[2] = hours % 24;
+    m_rtcRegisters[3] = days & 0xFF;
+    m_rtcRegisters[4] = (m_rtcRegisters[4] & 0xFE) | ((days >> 8) & 0x01);
+
+    // The day counter overflow is kept in bit 7 until the game clears it
+    if (days > 0x1FF) {
+        m_rtcRegisters[4] |= 0x80;
+    }
+}
+
+void gbtest::Cartridge::saveState(StateWriter& writer) const
+{
+    writer.write(m_ramEnabled);
+    writer.write(m_romBankRegister);
+    writer.write(m_secondaryBankRegister);
+    writer.write(m_advancedBankingMode);
+
+    writer.write(m_rtcRegisters);
+    writer.write(m_rtcLatchedRegisters);
+    writer.write(m_rtcLatchValue);
+    writer.write(m_rtcSynchronizedCycle);
+    writer.write(m_rtcSubsecondCycles);
+
+    writer.writeBytes(m_ram.data(), m_ram.size());
+}
+
+void gbtest::Cartridge::loadState(StateReader& reader)
+{
+    reader.read(m_ramEnabled);
+    reader.read(m_romBankRegister);
+    reader.read(m_secondaryBankRegister);
+    reader.read(m_advancedBankingMode);
+
+    reader.read(m_rtcRegisters);
+    reader.read(m_rtcLatchedRegisters);
+    reader.read(m_rtcLatchValue);
+    reader.read(m_rtcSynchronizedCycle);
+    reader.read(m_rtcSubsecondCycles);
+
+    reader.readBytes(m_ram.data(), m_ram.size());
+
+    // Point the bus to the loaded banks
+    if (isLoaded()) {
+        updateBanks();
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef GBTEST_CARTRIDGE_H
+#define GBTEST_CARTRIDGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CartridgeLoadStatus.h"
+#include "MappedFile.h"
+#include "MBCType.h"
+
+#include "../platform/bus/Bus.h"
+#include "../platform/bus/BusProvider.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
+
+namespace gbtest {
+
+/*
+ * Cartridge ROM (0000h to 7FFFh) and external RAM (A000h to BFFFh), with the bank switching of its MBC
+ * The ROM file is memory mapped, and bank switches swap the pointers the bus reads through
+ * Until a ROM is loaded, the cartridge doesn't handle any address
+ */
+class Cartridge
+        : public BusProvider {
+
+public:
+    explicit Cartridge(Bus& bus);
+    ~Cartridge() override = default;
+
+    [[nodiscard]] CartridgeLoadStatus load(const std::string& romPath);
+    void unload();
+
+    [[nodiscard]] bool isLoaded() const;
+    [[nodiscard]] MBCType getMbcType() const;
+    [[nodiscard]] size_t getRomSize() const;
+    [[nodiscard]] unsigned getRomBankNumber() const; // Bank mapped at 4000h (1 without a ROM)
+    [[nodiscard]] size_t getOwnedMemorySize() const; // Without the mapped ROM, shared with the other instances
+
+    [[nodiscard]] std::vector<uint8_t>& getRam();
+    [[nodiscard]] const std::vector<uint8_t>& getRam() const;
+
+    [[nodiscard]] static const char* getLoadStatusDescription(CartridgeLoadStatus loadStatus);
+
+    // The ROM isn't part of the state, the same one must be loaded when loading a state
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+    bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
+private:
+    Bus& m_bus;
+
+    MappedFile m_romFile;
+    std::vector<uint8_t> m_paddedRom; // Copy of the ROM files that aren't made of whole banks
+    const uint8_t* m_rom;
+    size_t m_romBankCount;
+
+    std::vector<uint8_t> m_ram;
+
+    // MBC registers
+    MBCType m_mbcType;
+    bool m_ramEnabled;
+    uint16_t m_romBankRegister;     // MBC1: 5 bits, MBC3: 7 bits, MBC5: 9 bits
+    uint8_t m_secondaryBankRegister; // MBC1: RAM bank or upper ROM bank bits, MBC3: RAM bank or RTC register, MBC5: RAM bank
+    bool m_advancedBankingMode;     // MBC1 only
+
+    // MBC3 real time clock (seconds, minutes, hours, lower and upper day counter), it counts emulated time
+    std::array<uint8_t, 5> m_rtcRegisters;
+    std::array<uint8_t, 5> m_rtcLatchedRegisters;
+    uint8_t m_rtcLatchValue;
+    uint64_t m_rtcSynchronizedCycle;    // Cycle the clock registers are up to date with
+    uint32_t m_rtcSubsecondCycles;      // Cycles counted toward the next second
+
+    // Current banks, derived from the registers
+    const uint8_t* m_romBank0;  // Mapped at 0000h
+    const uint8_t* m_romBankN;  // Mapped at 4000h
+    uint8_t* m_ramBank;         // Mapped at A000h (nullptr if disabled, absent or smaller than a bank)
+    size_t m_ramBankOffset;
+
+    void writeRegister(uint16_t addr, uint8_t val);
+    void updateBanks();
+
+    [[nodiscard]] bool isRtcSelected() const;
+    void synchronizeRtc();
+    void advanceRtc(uint64_t secondCount);
+
+}; // class Cartridge
+
+} // namespace gbtest
+
+#endif //GBTEST_CARTRIDGE_H
@@ -0,0 +1,15 @@
+#ifndef GBTEST_CARTRIDGELOADSTATUS_H
+#define GBTEST_CARTRIDGELOADSTATUS_H
+
+namespace gbtest {
+
+enum class CartridgeLoadStatus {
+    Success,
+    CantOpenFile,   // The file doesn't exist or can't be mapped
+    InvalidRom,     // The file is too small to contain a cartridge header
+    UnsupportedMbc, // The cartridge type from the header isn't supported
+}; // enum class CartridgeLoadStatus
+
+} // namespace gbtest
+
+#endif //GBTEST_CARTRIDGELOADSTATUS_H
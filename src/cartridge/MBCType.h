@@ -0,0 +1,16 @@
+#ifndef GBTEST_MBCTYPE_H
+#define GBTEST_MBCTYPE_H
+
+namespace gbtest {
+
+// Memory Bank Controller of a cartridge
+enum class MBCType {
+    None,   // 32 KiB ROM only (with up to 8 KiB of RAM)
+    MBC1,   // Up to 2 MiB ROM and 32 KiB RAM
+    MBC3,   // Up to 2 MiB ROM and 32 KiB RAM, with a real time clock
+    MBC5,   // Up to 8 MiB ROM and 128 KiB RAM
+}; // enum class MBCType
+
+} // namespace gbtest
+
+#endif //GBTEST_MBCTYPE_H
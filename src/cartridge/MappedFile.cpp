@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+gbtest::MappedFile::MappedFile()
+        : m_data(nullptr)
+        , m_size(0)
+#ifdef _WIN32
+        , m_fileHandle(INVALID_HANDLE_VALUE)
+        , m_mappingHandle(nullptr)
+#endif
+{
+
+}
+
+gbtest::MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool gbtest::MappedFile::open(const std::string& path)
+{
+    close();
+
+    m_fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle == nullptr) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void gbtest::MappedFile::close()
+{
+    if (m_data != nullptr) { UnmapViewOfFile(m_data); }
+    if (m_mappingHandle != nullptr) { CloseHandle(m_mappingHandle); }
+    if (m_fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(m_fileHandle); }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mappingHandle = nullptr;
+    m_fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool gbtest::MappedFile::open(const std::string& path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid once the descriptor is closed
+    void* const data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) { return false; }
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    return true;
+}
+
+void gbtest::MappedFile::close()
+{
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+bool gbtest::MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const uint8_t* gbtest::MappedFile::getData() const
+{
+    return m_data;
+}
+
+size_t gbtest::MappedFile::getSize() const
+{
+    return m_size;
+}
@@ -0,0 +1,43 @@
+#ifndef GBTEST_MAPPEDFILE_H
+#define GBTEST_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gbtest {
+
+/*
+ * Read-only memory mapping of a whole file
+ * Pages are loaded on first access and shared with every other process mapping the same file
+ */
+class MappedFile {
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] const uint8_t* getData() const;
+    [[nodiscard]] size_t getSize() const;
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+
+}; // class MappedFile
+
+} // namespace gbtest
+
+#endif //GBTEST_MAPPEDFILE_H
@@ -1,82 +1,31 @@
+#include <algorithm>
+#include <array>
 #include <cassert>
-#include <iomanip>
-#include <iostream>
-#include <stdexcept>
 
 #include "LR35902.h"
 
 gbtest::LR35902::LR35902(Bus& bus)
         : m_bus(bus)
-        , m_opcodeLookup(
-                {[this] { opcode00h(); }, [this] { opcode01h(); }, [this] { opcode02h(); }, [this] { opcode03h(); },
-                 [this] { opcode04h(); }, [this] { opcode05h(); }, [this] { opcode06h(); }, [this] { opcode07h(); },
-                 [this] { opcode08h(); }, [this] { opcode09h(); }, [this] { opcode0Ah(); }, [this] { opcode0Bh(); },
-                 [this] { opcode0Ch(); }, [this] { opcode0Dh(); }, [this] { opcode0Eh(); }, [this] { opcode0Fh(); },
-                 [this] { opcode10h(); }, [this] { opcode11h(); }, [this] { opcode12h(); }, [this] { opcode13h(); },
-                 [this] { opcode14h(); }, [this] { opcode15h(); }, [this] { opcode16h(); }, [this] { opcode17h(); },
-                 [this] { opcode18h(); }, [this] { opcode19h(); }, [this] { opcode1Ah(); }, [this] { opcode1Bh(); },
-                 [this] { opcode1Ch(); }, [this] { opcode1Dh(); }, [this] { opcode1Eh(); }, [this] { opcode1Fh(); },
-                 [this] { opcode20h(); }, [this] { opcode21h(); }, [this] { opcode22h(); }, [this] { opcode23h(); },
-                 [this] { opcode24h(); }, [this] { opcode25h(); }, [this] { opcode26h(); }, [this] { opcode27h(); },
-                 [this] { opcode28h(); }, [this] { opcode29h(); }, [this] { opcode2Ah(); }, [this] { opcode2Bh(); },
-                 [this] { opcode2Ch(); }, [this] { opcode2Dh(); }, [this] { opcode2Eh(); }, [this] { opcode2Fh(); },
-                 [this] { opcode30h(); }, [this] { opcode31h(); }, [this] { opcode32h(); }, [this] { opcode33h(); },
-                 [this] { opcode34h(); }, [this] { opcode35h(); }, [this] { opcode36h(); }, [this] { opcode37h(); },
-                 [this] { opcode38h(); }, [this] { opcode39h(); }, [this] { opcode3Ah(); }, [this] { opcode3Bh(); },
-                 [this] { opcode3Ch(); }, [this] { opcode3Dh(); }, [this] { opcode3Eh(); }, [this] { opcode3Fh(); },
-                 [this] { opcode40h(); }, [this] { opcode41h(); }, [this] { opcode42h(); }, [this] { opcode43h(); },
-                 [this] { opcode44h(); }, [this] { opcode45h(); }, [this] { opcode46h(); }, [this] { opcode47h(); },
-                 [this] { opcode48h(); }, [this] { opcode49h(); }, [this] { opcode4Ah(); }, [this] { opcode4Bh(); },
-                 [this] { opcode4Ch(); }, [this] { opcode4Dh(); }, [this] { opcode4Eh(); }, [this] { opcode4Fh(); },
-                 [this] { opcode50h(); }, [this] { opcode51h(); }, [this] { opcode52h(); }, [this] { opcode53h(); },
-                 [this] { opcode54h(); }, [this] { opcode55h(); }, [this] { opcode56h(); }, [this] { opcode57h(); },
-                 [this] { opcode58h(); }, [this] { opcode59h(); }, [this] { opcode5Ah(); }, [this] { opcode5Bh(); },
-                 [this] { opcode5Ch(); }, [this] { opcode5Dh(); }, [this] { opcode5Eh(); }, [this] { opcode5Fh(); },
-                 [this] { opcode60h(); }, [this] { opcode61h(); }, [this] { opcode62h(); }, [this] { opcode63h(); },
-                 [this] { opcode64h(); }, [this] { opcode65h(); }, [this] { opcode66h(); }, [this] { opcode67h(); },
-                 [this] { opcode68h(); }, [this] { opcode69h(); }, [this] { opcode6Ah(); }, [this] { opcode6Bh(); },
-                 [this] { opcode6Ch(); }, [this] { opcode6Dh(); }, [this] { opcode6Eh(); }, [this] { opcode6Fh(); },
-                 [this] { opcode70h(); }, [this] { opcode71h(); }, [this] { opcode72h(); }, [this] { opcode73h(); },
-                 [this] { opcode74h(); }, [this] { opcode75h(); }, [this] { opcode76h(); }, [this] { opcode77h(); },
-                 [this] { opcode78h(); }, [this] { opcode79h(); }, [this] { opcode7Ah(); }, [this] { opcode7Bh(); },
-                 [this] { opcode7Ch(); }, [this] { opcode7Dh(); }, [this] { opcode7Eh(); }, [this] { opcode7Fh(); },
-                 [this] { opcode80h(); }, [this] { opcode81h(); }, [this] { opcode82h(); }, [this] { opcode83h(); },
-                 [this] { opcode84h(); }, [this] { opcode85h(); }, [this] { opcode86h(); }, [this] { opcode87h(); },
-                 [this] { opcode88h(); }, [this] { opcode89h(); }, [this] { opcode8Ah(); }, [this] { opcode8Bh(); },
-                 [this] { opcode8Ch(); }, [this] { opcode8Dh(); }, [this] { opcode8Eh(); }, [this] { opcode8Fh(); },
-                 [this] { opcode90h(); }, [this] { opcode91h(); }, [this] { opcode92h(); }, [this] { opcode93h(); },
-                 [this] { opcode94h(); }, [this] { opcode95h(); }, [this] { opcode96h(); }, [this] { opcode97h(); },
-                 [this] { opcode98h(); }, [this] { opcode99h(); }, [this] { opcode9Ah(); }, [this] { opcode9Bh(); },
-                 [this] { opcode9Ch(); }, [this] { opcode9Dh(); }, [this] { opcode9Eh(); }, [this] { opcode9Fh(); },
-                 [this] { opcodeA0h(); }, [this] { opcodeA1h(); }, [this] { opcodeA2h(); }, [this] { opcodeA3h(); },
-                 [this] { opcodeA4h(); }, [this] { opcodeA5h(); }, [this] { opcodeA6h(); }, [this] { opcodeA7h(); },
-                 [this] { opcodeA8h(); }, [this] { opcodeA9h(); }, [this] { opcodeAAh(); }, [this] { opcodeABh(); },
-                 [this] { opcodeACh(); }, [this] { opcodeADh(); }, [this] { opcodeAEh(); }, [this] { opcodeAFh(); },
-                 [this] { opcodeB0h(); }, [this] { opcodeB1h(); }, [this] { opcodeB2h(); }, [this] { opcodeB3h(); },
-                 [this] { opcodeB4h(); }, [this] { opcodeB5h(); }, [this] { opcodeB6h(); }, [this] { opcodeB7h(); },
-                 [this] { opcodeB8h(); }, [this] { opcodeB9h(); }, [this] { opcodeBAh(); }, [this] { opcodeBBh(); },
-                 [this] { opcodeBCh(); }, [this] { opcodeBDh(); }, [this] { opcodeBEh(); }, [this] { opcodeBFh(); },
-                 [this] { opcodeC0h(); }, [this] { opcodeC1h(); }, [this] { opcodeC2h(); }, [this] { opcodeC3h(); },
-                 [this] { opcodeC4h(); }, [this] { opcodeC5h(); }, [this] { opcodeC6h(); }, [this] { opcodeC7h(); },
-                 [this] { opcodeC8h(); }, [this] { opcodeC9h(); }, [this] { opcodeCAh(); }, [this] { opcodeCBh(); },
-                 [this] { opcodeCCh(); }, [this] { opcodeCDh(); }, [this] { opcodeCEh(); }, [this] { opcodeCFh(); },
-                 [this] { opcodeD0h(); }, [this] { opcodeD1h(); }, [this] { opcodeD2h(); }, [this] { opcodeD3h(); },
-                 [this] { opcodeD4h(); }, [this] { opcodeD5h(); }, [this] { opcodeD6h(); }, [this] { opcodeD7h(); },
-                 [this] { opcodeD8h(); }, [this] { opcodeD9h(); }, [this] { opcodeDAh(); }, [this] { opcodeDBh(); },
-                 [this] { opcodeDCh(); }, [this] { opcodeDDh(); }, [this] { opcodeDEh(); }, [this] { opcodeDFh(); },
-                 [this] { opcodeE0h(); }, [this] { opcodeE1h(); }, [this] { opcodeE2h(); }, [this] { opcodeE3h(); },
-                 [this] { opcodeE4h(); }, [this] { opcodeE5h(); }, [this] { opcodeE6h(); }, [this] { opcodeE7h(); },
-                 [this] { opcodeE8h(); }, [this] { opcodeE9h(); }, [this] { opcodeEAh(); }, [this] { opcodeEBh(); },
-                 [this] { opcodeECh(); }, [this] { opcodeEDh(); }, [this] { opcodeEEh(); }, [this] { opcodeEFh(); },
-                 [this] { opcodeF0h(); }, [this] { opcodeF1h(); }, [this] { opcodeF2h(); }, [this] { opcodeF3h(); },
-                 [this] { opcodeF4h(); }, [this] { opcodeF5h(); }, [this] { opcodeF6h(); }, [this] { opcodeF7h(); },
-                 [this] { opcodeF8h(); }, [this] { opcodeF9h(); }, [this] { opcodeFAh(); }, [this] { opcodeFBh(); },
-                 [this] { opcodeFCh(); }, [this] { opcodeFDh(); }, [this] { opcodeFEh(); }, [this] { opcodeFFh(); }})
         , m_interruptController(bus)
+#ifdef GBTEST_CPU_LAZY_FLAGS
+        , m_flagZResult(1)
+        , m_flagN(false)
+        , m_flagHBits(0)
+        , m_flagCBits(0)
+#endif
         , m_cyclesToWait(0)
         , m_halted(false)
         , m_stopped(false)
+        , m_haltBug(false)
         , m_tickCounter(0)
+        , m_blockCache(std::make_unique<DecodedBlockCache>(bus, s_opcodeHandlers))
+        , m_decodedOperands(nullptr)
+#ifdef GBTEST_CPU_PROFILER
+        , m_profiler(nullptr)
+#endif
+#ifdef GBTEST_CPU_TRACE
+        , m_trace(nullptr)
+#endif
 {
 
 }
@@ -84,10 +33,12 @@ gbtest::LR35902::LR35902(Bus& bus)
 void gbtest::LR35902::setRegisters(const LR35902Registers& registers)
 {
     m_registers = registers;
+    loadFlags();
 }
 
 const gbtest::LR35902Registers& gbtest::LR35902::getRegisters() const
 {
+    storeFlags();
     return m_registers;
 }
 
@@ -133,31 +84,250 @@ const unsigned& gbtest::LR35902::getTickCounter() const
 
 void gbtest::LR35902::tick()
 {
-    // Tick the interrupt controller
-    m_interruptController.tick();
-
     if (m_cyclesToWait == 0) {
-        // Handle interrupts before fetching the instruction
-        handleInterrupt();
+        executeInstruction();
+    }
+    else {
+        // Tick the interrupt controller
+        m_interruptController.tick();
+    }
+
+    ++m_tickCounter;
+    --m_cyclesToWait;
+}
+
+uint64_t gbtest::LR35902::runFor(uint64_t cycleCount)
+{
+    Scheduler& scheduler = m_bus.getScheduler();
+    const uint64_t startCycle = scheduler.getCurrentCycle();
+    const uint64_t targetCycle = startCycle + cycleCount;
+
+    while (scheduler.getCurrentCycle() < targetCycle) {
+        const uint64_t currentCycle = scheduler.getCurrentCycle();
+
+        // Skip the remaining cycles of the current instruction in one go
+        if (m_cyclesToWait > 0) {
+            const uint8_t cyclesToWaste = std::min<uint64_t>(m_cyclesToWait, targetCycle - currentCycle);
 
-        // Execute current instruction
-        const uint8_t opcode = fetch();
-        try {
-            m_opcodeLookup[opcode]();
+            wasteCycles(cyclesToWaste);
+            scheduler.advance(cyclesToWaste);
+            continue;
         }
-        catch (const std::runtime_error& e) {
-            std::cerr << std::uppercase << std::hex
-                      << "PC = 0x" << m_registers.pc << "; Opcode = 0x" << (int) opcode << std::endl
-                      << "Caught exception: " << e.what() << std::endl;
+
+        // Stop at the instruction boundary if a device has something to show before it
+        if (scheduler.getNextEventCycle() < currentCycle) { break; }
+
+        /*
+         * Only a device event can wake a halted CPU up, jump straight to it instead of spinning
+         * The CPU checks for interrupts once every 4 cycles from the HALT, like it would between two NOPs: only whole
+         * checks are skipped, so that they land on the same cycles however the emulated time is split into calls
+         */
+        if (m_halted && !shouldWakeUp()) {
+            const uint64_t nextEventCycle = scheduler.getNextEventCycle();
+            uint64_t haltedCycles = (targetCycle - currentCycle) & ~static_cast<uint64_t>(3);
+
+            if (nextEventCycle != Scheduler::NoEvent) {
+                haltedCycles = std::min((nextEventCycle - currentCycle + 4) & ~static_cast<uint64_t>(3), haltedCycles);
+            }
+
+            // Less than a check before the target, it is started below and finished by the next call
+            if (haltedCycles > 0) {
+                m_tickCounter += haltedCycles;
+                scheduler.advance(haltedCycles);
+                continue;
+            }
         }
 
-        // Handle delayed interrupt enable
-        m_interruptController.handleDelayedInterrupt();
+#ifdef GBTEST_CPU_JIT
+        // Or a whole compiled block, leaving the CPU either at an instruction boundary or with cycles to waste
+        if (m_jit != nullptr && runJitBlock(targetCycle)) { continue; }
+#endif
+
+        // Or a whole decoded block, with the same outcome
+        if (m_blockCache != nullptr && runDecodedBlock(targetCycle)) { continue; }
+
+        // Execute the next instruction, its first cycle included
+        executeInstruction();
+
+        ++m_tickCounter;
+        --m_cyclesToWait;
+        scheduler.advance(1);
     }
 
-    ++m_tickCounter;
-    --m_cyclesToWait;
+    return scheduler.getCurrentCycle() - startCycle;
+}
+
+void gbtest::LR35902::setBlockCacheEnabled(bool enabled)
+{
+    if (!enabled) {
+        m_blockCache.reset();
+    }
+    else if (m_blockCache == nullptr) {
+        m_blockCache = std::make_unique<DecodedBlockCache>(m_bus, s_opcodeHandlers);
+    }
+}
+
+bool gbtest::LR35902::isBlockCacheEnabled() const
+{
+    return m_blockCache != nullptr;
+}
+
+void gbtest::LR35902::flushBlockCache()
+{
+    if (m_blockCache != nullptr) {
+        m_blockCache->flush();
+    }
+}
+
+size_t gbtest::LR35902::getOwnedMemorySize() const
+{
+    return (m_blockCache != nullptr) ? m_blockCache->getOwnedMemorySize() : 0;
+}
+
+bool gbtest::LR35902::runDecodedBlock(uint64_t targetCycle)
+{
+    // Look the block up first, most instructions of the code running once start no block
+    const DecodedBlockCache::Block* block = m_blockCache->getBlock(m_registers.pc);
+
+    if (block == nullptr || !canRunBlock()) { return false; }
+
+    // The devices may look at the current cycle on every access, it's kept up to date after each instruction
+    Scheduler& scheduler = m_bus.getScheduler();
+    const uint64_t limitCycle = getBlockLimitCycle(targetCycle);
+    uint64_t& currentCycle = *scheduler.getCurrentCycleData();
+
+    for (size_t i = 0; i < block->instructionCount; ++i) {
+        // Every instruction but the first starts like in runFor(), the caller checked the first one
+        if (i > 0 && currentCycle >= limitCycle) { break; }
+
+        // Skip the opcode like the fetch would, the handler fetches the rest from the decoded operands
+        const DecodedBlockCache::Instruction& instruction = block->instructions[i];
+
+#ifdef GBTEST_CPU_TRACE
+        if (m_trace != nullptr) {
+            // PC from the decoded instruction, reading it back from the registers the last handler wrote stalls
+            traceInstruction(instruction.nextPc - 1, instruction.opcode, currentCycle);
+        }
+#endif
+
+        m_registers.pc = instruction.nextPc;
+        m_decodedOperands = instruction.operands.data();
+        instruction.handler(this);
+
+        // Same accounting as after executeInstruction() if the target cycle is reached, runFor() wastes the rest
+        if (currentCycle + m_cyclesToWait > targetCycle) {
+            ++m_tickCounter;
+            --m_cyclesToWait;
+            ++currentCycle;
+            break;
+        }
+
+        m_tickCounter += m_cyclesToWait;
+        currentCycle += m_cyclesToWait;
+        m_cyclesToWait = 0;
+    }
+
+    m_decodedOperands = nullptr;
+
+    // The last instruction may be EI
+    m_interruptController.handleDelayedInterrupt();
+
+    return true;
+}
+
+bool gbtest::LR35902::canRunBlock()
+{
+    // The interpreter takes over whenever executeInstruction() would do more than executing the instruction
+    if (m_halted || m_haltBug) { return false; }
+
+#ifdef GBTEST_CPU_PROFILER
+    if (m_profiler != nullptr) { return false; }
+#endif
+
+    m_interruptController.tick();
+
+    if (m_interruptController.hasDelayedInterruptEnable()) { return false; }
+
+    return !(m_interruptController.isInterruptMasterEnabled() && m_interruptController.hasPendingInterrupt());
+}
+
+uint64_t gbtest::LR35902::getBlockLimitCycle(uint64_t targetCycle) const
+{
+    // Blocks don't start an instruction past the cycle where runFor() would have stopped
+    const uint64_t nextEventCycle = m_bus.getScheduler().getNextEventCycle();
+
+    return (nextEventCycle == Scheduler::NoEvent) ? targetCycle : std::min(nextEventCycle + 1, targetCycle);
+}
+
+#ifdef GBTEST_CPU_JIT
+void gbtest::LR35902::setJitEnabled(bool enabled)
+{
+    if (!enabled) {
+        m_jit.reset();
+    }
+    else if (m_jit == nullptr && JitCompiler::isSupported()) {
+        m_jit = std::make_unique<JitCompiler>(*this, m_bus);
+    }
+}
+
+bool gbtest::LR35902::isJitEnabled() const
+{
+    return m_jit != nullptr;
+}
+
+bool gbtest::LR35902::runJitBlock(uint64_t targetCycle)
+{
+#ifdef GBTEST_CPU_TRACE
+    // The compiled blocks don't record the instructions they run
+    if (m_trace != nullptr) { return false; }
+
+#endif
+    if (!canRunBlock()) { return false; }
+
+    Scheduler& scheduler = m_bus.getScheduler();
+    const uint64_t limitCycle = getBlockLimitCycle(targetCycle);
+
+    const JitBlockExit blockExit = m_jit->runBlock(limitCycle, targetCycle);
+
+    if (blockExit == JitBlockExit::NotCompiled) { return false; }
+
+    // Same accounting as after executeInstruction(), the rest of the cycles is wasted by runFor()
+    if (blockExit == JitBlockExit::CyclesPending) {
+        ++m_tickCounter;
+        --m_cyclesToWait;
+        scheduler.advance(1);
+    }
+
+    // The last instruction may be EI
+    m_interruptController.handleDelayedInterrupt();
+
+    return true;
 }
+#endif
+
+#ifdef GBTEST_CPU_PROFILER
+void gbtest::LR35902::setProfiler(CpuProfiler* profiler)
+{
+    m_profiler = profiler;
+}
+
+gbtest::CpuProfiler* gbtest::LR35902::getProfiler() const
+{
+    return m_profiler;
+}
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+void gbtest::LR35902::setTrace(InstructionTrace* trace)
+{
+    m_trace = trace;
+}
+
+gbtest::InstructionTrace* gbtest::LR35902::getTrace() const
+{
+    return m_trace;
+}
+#endif
 
 void gbtest::LR35902::step()
 {
@@ -171,11 +341,310 @@ void gbtest::LR35902::step()
     tick();
 }
 
+void gbtest::LR35902::wasteCycles(uint8_t cycleCount)
+{
+    // Same as calling tick() while the CPU is still busy with its current instruction, in one go
+    assert(cycleCount <= m_cyclesToWait);
+
+    m_tickCounter += cycleCount;
+    m_cyclesToWait -= cycleCount;
+}
+
+// Every opcode value, used to generate the dispatchers of both instruction sets
+#define GBTEST_LR35902_OPCODES(X) \
+    X(00) X(01) X(02) X(03) X(04) X(05) X(06) X(07) X(08) X(09) X(0A) X(0B) X(0C) X(0D) X(0E) X(0F) \
+    X(10) X(11) X(12) X(13) X(14) X(15) X(16) X(17) X(18) X(19) X(1A) X(1B) X(1C) X(1D) X(1E) X(1F) \
+    X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(2A) X(2B) X(2C) X(2D) X(2E) X(2F) \
+    X(30) X(31) X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(3A) X(3B) X(3C) X(3D) X(3E) X(3F) \
+    X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47) X(48) X(49) X(4A) X(4B) X(4C) X(4D) X(4E) X(4F) \
+    X(50) X(51) X(52) X(53) X(54) X(55) X(56) X(57) X(58) X(59) X(5A) X(5B) X(5C) X(5D) X(5E) X(5F) \
+    X(60) X(61) X(62) X(63) X(64) X(65) X(66) X(67) X(68) X(69) X(6A) X(6B) X(6C) X(6D) X(6E) X(6F) \
+    X(70) X(71) X(72) X(73) X(74) X(75) X(76) X(77) X(78) X(79) X(7A) X(7B) X(7C) X(7D) X(7E) X(7F) \
+    X(80) X(81) X(82) X(83) X(84) X(85) X(86) X(87) X(88) X(89) X(8A) X(8B) X(8C) X(8D) X(8E) X(8F) \
+    X(90) X(91) X(92) X(93) X(94) X(95) X(96) X(97) X(98) X(99) X(9A) X(9B) X(9C) X(9D) X(9E) X(9F) \
+    X(A0) X(A1) X(A2) X(A3) X(A4) X(A5) X(A6) X(A7) X(A8) X(A9) X(AA) X(AB) X(AC) X(AD) X(AE) X(AF) \
+    X(B0) X(B1) X(B2) X(B3) X(B4) X(B5) X(B6) X(B7) X(B8) X(B9) X(BA) X(BB) X(BC) X(BD) X(BE) X(BF) \
+    X(C0) X(C1) X(C2) X(C3) X(C4) X(C5) X(C6) X(C7) X(C8) X(C9) X(CA) X(CB) X(CC) X(CD) X(CE) X(CF) \
+    X(D0) X(D1) X(D2) X(D3) X(D4) X(D5) X(D6) X(D7) X(D8) X(D9) X(DA) X(DB) X(DC) X(DD) X(DE) X(DF) \
+    X(E0) X(E1) X(E2) X(E3) X(E4) X(E5) X(E6) X(E7) X(E8) X(E9) X(EA) X(EB) X(EC) X(ED) X(EE) X(EF) \
+    X(F0) X(F1) X(F2) X(F3) X(F4) X(F5) X(F6) X(F7) X(F8) X(F9) X(FA) X(FB) X(FC) X(FD) X(FE) X(FF)
+
+void gbtest::LR35902::execute(uint8_t opcode)
+{
+    // The handlers are defined in this file, so the compiler is free to inline them in the dispatcher
+#define GBTEST_LR35902_CASE(op) case 0x##op: opcode##op##h(); break;
+
+    switch (opcode) {
+    GBTEST_LR35902_OPCODES(GBTEST_LR35902_CASE)
+    }
+
+#undef GBTEST_LR35902_CASE
+}
+
+// Cycles of the 0xCB-prefixed instructions, the prefix included
+static constexpr std::array<uint8_t, 0x100> s_cbOpcodeCycles = [] {
+    std::array<uint8_t, 0x100> cycles{};
+
+    for (size_t cbOpcode = 0; cbOpcode < cycles.size(); ++cbOpcode) {
+        if (gbtest::getCBOperandIndex(cbOpcode) != 0x6) {
+            cycles[cbOpcode] = 8;
+        }
+        else {
+            // (HL): BIT only reads the memory, the others read and write it back
+            cycles[cbOpcode] = (gbtest::getCBOperation(cbOpcode) == gbtest::CBOperation::BIT) ? 12 : 16;
+        }
+    }
+
+    return cycles;
+}();
+
+void gbtest::LR35902::executeCB(uint8_t cbOpcode)
+{
+    // Same dispatch as execute(), each case being a handler specialized for its opcode
+#define GBTEST_LR35902_CB_CASE(op) case 0x##op: executeCBOpcode<0x##op>(); break;
+
+    switch (cbOpcode) {
+    GBTEST_LR35902_OPCODES(GBTEST_LR35902_CB_CASE)
+    }
+
+#undef GBTEST_LR35902_CB_CASE
+}
+
+#define GBTEST_LR35902_HANDLER(op) [](LR35902* cpu) -> void { cpu->opcode##op##h(); },
+
+const gbtest::LR35902::OpcodeHandler gbtest::LR35902::s_opcodeHandlers[0x100] = {
+        GBTEST_LR35902_OPCODES(GBTEST_LR35902_HANDLER)
+};
+
+#undef GBTEST_LR35902_HANDLER
+
+#undef GBTEST_LR35902_OPCODES
+
+void gbtest::LR35902::executeInstruction()
+{
+    // Tick the interrupt controller
+    m_interruptController.tick();
+
+    // Stay halted until an interrupt wakes the CPU up
+    if (m_halted) {
+        if (!shouldWakeUp()) {
+            m_cyclesToWait = 4;
+            return;
+        }
+
+        m_halted = false;
+        m_stopped = false;
+    }
+
+    // Handle interrupts before fetching the instruction
+    handleInterrupt();
+
+#if defined(GBTEST_CPU_PROFILER) || defined(GBTEST_CPU_TRACE)
+    const uint16_t pc = m_registers.pc;
+    [[maybe_unused]] const uint16_t sp = m_registers.sp;
+    const uint8_t opcode = fetchOpcode();
+
+#ifdef GBTEST_CPU_TRACE
+    // Before running it, so that the instruction at fault is already in the trace
+    if (m_trace != nullptr) {
+        traceInstruction(pc, opcode, m_bus.getScheduler().getCurrentCycle());
+    }
+#endif
+
+    execute(opcode);
+
+#ifdef GBTEST_CPU_PROFILER
+    if (m_profiler != nullptr) {
+        profileInstruction(opcode, pc, sp);
+    }
+#endif
+#else
+    // Execute current instruction
+    execute(fetchOpcode());
+#endif
+
+    // Handle delayed interrupt enable
+    m_interruptController.handleDelayedInterrupt();
+}
+
+void gbtest::LR35902::executeIllegalOpcode()
+{
+    // The CPU locks up: keep fetching the same opcode until the bus error policy stops the emulation
+    --m_registers.pc;
+    m_bus.reportFault(BusFaultType::IllegalOpcode, m_registers.pc, BusRequestSource::CPU);
+
+    m_cyclesToWait = 4;
+}
+
+bool gbtest::LR35902::shouldWakeUp()
+{
+    // Take the interrupt lines raised by the devices since the last tick
+    m_interruptController.tick();
+
+    // Stopped: only a joypad press wakes the CPU up, even if its interrupt is disabled
+    if (m_stopped) {
+        return m_interruptController.isInterruptRequested(InterruptType::Joypad);
+    }
+
+    // Halted: any enabled interrupt request wakes the CPU up, even if the interrupts are disabled
+    return m_interruptController.hasPendingInterrupt();
+}
+
 uint8_t gbtest::LR35902::fetch()
 {
+    // The bytes following the opcode of a decoded instruction were read when decoding it
+    if (m_decodedOperands != nullptr) {
+        ++m_registers.pc;
+        return *(m_decodedOperands++);
+    }
+
     return m_bus.read(m_registers.pc++, gbtest::BusRequestSource::CPU);
 }
 
+uint8_t gbtest::LR35902::fetchOpcode()
+{
+    const uint8_t opcode = fetch();
+
+    // HALT bug: PC isn't incremented, the opcode byte is read again as the next byte
+    if (m_haltBug) {
+        --m_registers.pc;
+        m_haltBug = false;
+    }
+
+    return opcode;
+}
+
+bool gbtest::LR35902::getFlagZ() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    return m_flagZResult == 0;
+#else
+    return m_registers.f.z;
+#endif
+}
+
+bool gbtest::LR35902::getFlagN() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    return m_flagN;
+#else
+    return m_registers.f.n;
+#endif
+}
+
+bool gbtest::LR35902::getFlagH() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    return (m_flagHBits & 0x10) != 0;
+#else
+    return m_registers.f.h;
+#endif
+}
+
+bool gbtest::LR35902::getFlagC() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    return (m_flagCBits & 0x100) != 0;
+#else
+    return m_registers.f.c;
+#endif
+}
+
+void gbtest::LR35902::setFlagZ(bool z)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagZResult = z ? 0 : 1;
+#else
+    m_registers.f.z = z;
+#endif
+}
+
+void gbtest::LR35902::setFlagN(bool n)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagN = n;
+#else
+    m_registers.f.n = n;
+#endif
+}
+
+void gbtest::LR35902::setFlagH(bool h)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagHBits = h ? 0x10 : 0x00;
+#else
+    m_registers.f.h = h;
+#endif
+}
+
+void gbtest::LR35902::setFlagC(bool c)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagCBits = c ? 0x100 : 0x000;
+#else
+    m_registers.f.c = c;
+#endif
+}
+
+void gbtest::LR35902::setFlagZFromResult(uint8_t result)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagZResult = result;
+#else
+    m_registers.f.z = (result == 0);
+#endif
+}
+
+void gbtest::LR35902::setFlagHFromOperation(unsigned lhs, unsigned rhs, unsigned result)
+{
+    // Bit 4 of the result is the one of the operands unless there was a carry (or a borrow) into it
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagHBits = lhs ^ rhs ^ result;
+#else
+    m_registers.f.h = ((lhs ^ rhs ^ result) >> 4) & 0x1;
+#endif
+}
+
+void gbtest::LR35902::setFlagCFromResult(unsigned result)
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_flagCBits = result;
+#else
+    m_registers.f.c = (result >> 8) & 0x1;
+#endif
+}
+
+uint8_t gbtest::LR35902::getFlags() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    // Same bits as storeFlags(), put together in a register
+    return static_cast<uint8_t>(((m_flagZResult == 0) << 7) | (m_flagN << 6) | ((m_flagHBits & 0x10) << 1)
+            | ((m_flagCBits & 0x100) >> 4));
+#else
+    return static_cast<uint8_t>(m_registers.af);
+#endif
+}
+
+void gbtest::LR35902::storeFlags() const
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    m_registers.f.z = getFlagZ();
+    m_registers.f.n = getFlagN();
+    m_registers.f.h = getFlagH();
+    m_registers.f.c = getFlagC();
+#endif
+}
+
+void gbtest::LR35902::loadFlags()
+{
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    setFlagZ(m_registers.f.z);
+    setFlagN(m_registers.f.n);
+    setFlagH(m_registers.f.h);
+    setFlagC(m_registers.f.c);
+#endif
+}
+
 void gbtest::LR35902::handleInterrupt()
 {
     // Don't do anything if interrupts are disabled
@@ -209,6 +678,12 @@ void gbtest::LR35902::handleInterrupt()
     m_interruptController.setInterruptRequested(static_cast<InterruptType>(1 << i), false);
     m_interruptController.setInterruptMasterEnable(false);
 
+    // HALT bug right after EI: the interrupt returns to the HALT, which runs again
+    if (m_haltBug) {
+        --m_registers.pc;
+        m_haltBug = false;
+    }
+
     // Call the interrupt vector
     m_bus.write(--m_registers.sp, m_registers.pc >> 8, gbtest::BusRequestSource::CPU);
     m_bus.write(--m_registers.sp, m_registers.pc, gbtest::BusRequestSource::CPU);
@@ -216,8 +691,53 @@ void gbtest::LR35902::handleInterrupt()
     m_registers.pc = vectorAddress;
 
     m_cyclesToWait = 20;
+
+#ifdef GBTEST_CPU_PROFILER
+    if (m_profiler != nullptr) {
+        m_profiler->onCall(vectorAddress);
+    }
+#endif
 }
 
+#ifdef GBTEST_CPU_PROFILER
+void gbtest::LR35902::profileInstruction(uint8_t opcode, uint16_t pc, uint16_t sp)
+{
+    m_profiler->onInstruction(pc, m_cyclesToWait);
+
+    // Calls and returns are told apart from pushes and pops by their opcode, taken or not by the stack pointer
+    switch (opcode) {
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:             // CALL
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+        if (m_registers.sp == static_cast<uint16_t>(sp - 2)) {
+            m_profiler->onCall(m_registers.pc);
+        }
+        break;
+
+    case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9:  // RET and RETI
+        if (m_registers.sp == static_cast<uint16_t>(sp + 2)) {
+            m_profiler->onReturn();
+        }
+        break;
+
+    default:
+        // Any other instruction going back without touching the stack closes a loop
+        if (m_registers.pc <= pc && m_registers.sp == sp) {
+            m_profiler->onBackwardJump(pc, m_registers.pc);
+        }
+        break;
+    }
+}
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+void gbtest::LR35902::traceInstruction(uint16_t pc, uint8_t opcode, uint64_t cycle)
+{
+    // F is put together in a register, storing the lazy flags would cost a write per flag on every instruction
+    const uint16_t af = (m_registers.af & 0xFF00) | getFlags();
+    m_trace->record(pc, opcode, af, m_registers, cycle);
+}
+#endif
+
 // NOP
 void gbtest::LR35902::opcode00h()
 {
@@ -269,13 +789,14 @@ void gbtest::LR35902::opcode06h()
 // RLCA
 void gbtest::LR35902::opcode07h()
 {
-    m_registers.f.c = (m_registers.a >> 7) & 0x1;
+    const uint8_t carry = (m_registers.a >> 7) & 0x1;
 
-    m_registers.a = (m_registers.a << 1) | m_registers.f.c;
+    m_registers.a = (m_registers.a << 1) | carry;
 
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
+    setFlagZ(false);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(carry);
 
     m_cyclesToWait = 4;
 }
@@ -333,13 +854,14 @@ void gbtest::LR35902::opcode0Eh()
 // RRCA
 void gbtest::LR35902::opcode0Fh()
 {
-    m_registers.f.c = m_registers.a & 0x1;
+    const uint8_t carry = m_registers.a & 0x1;
 
-    m_registers.a = (m_registers.a >> 1) | (m_registers.f.c << 7);
+    m_registers.a = (m_registers.a >> 1) | (carry << 7);
 
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
+    setFlagZ(false);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(carry);
 
     m_cyclesToWait = 4;
 }
@@ -347,7 +869,12 @@ void gbtest::LR35902::opcode0Fh()
 // STOP
 void gbtest::LR35902::opcode10h()
 {
-    // TODO: Implement that
+    // Skip the padding byte
+    fetch();
+
+    // The divider is reset, like with a write to DIV
+    m_bus.write(0xFF04, 0x00, gbtest::BusRequestSource::CPU);
+
     m_halted = true;
     m_stopped = true;
 
@@ -401,12 +928,12 @@ void gbtest::LR35902::opcode17h()
 {
     const uint8_t newCarry = (m_registers.a >> 7) & 0x1;
 
-    m_registers.a = (m_registers.a << 1) | m_registers.f.c;
+    m_registers.a = (m_registers.a << 1) | getFlagC();
 
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = newCarry;
+    setFlagZ(false);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(newCarry);
 
     m_cyclesToWait = 4;
 }
@@ -463,12 +990,12 @@ void gbtest::LR35902::opcode1Fh()
 {
     const uint8_t newCarry = m_registers.a & 0x1;
 
-    m_registers.a = (m_registers.a >> 1) | (m_registers.f.c << 7);
+    m_registers.a = (m_registers.a >> 1) | (getFlagC() << 7);
 
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = newCarry;
+    setFlagZ(false);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(newCarry);
 
     m_cyclesToWait = 4;
 }
@@ -478,7 +1005,7 @@ void gbtest::LR35902::opcode20h()
 {
     const auto val = (int8_t) fetch();
 
-    if (m_registers.f.z) {
+    if (getFlagZ()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -532,31 +1059,33 @@ void gbtest::LR35902::opcode26h()
 // DAA
 void gbtest::LR35902::opcode27h()
 {
-    if (m_registers.f.n == 0) {
+    if (getFlagN() == 0) {
         // Previous operation was an addition
-        if (m_registers.f.c || m_registers.a > 0x99) {
+        if (getFlagC() || m_registers.a > 0x99) {
             m_registers.a += 0x60;
-            m_registers.f.c = 1;
+            setFlagC(true);
         }
 
-        if (m_registers.f.h || (m_registers.a & 0x0F) > 0x09) {
+        if (getFlagH() || (m_registers.a & 0x0F) > 0x09) {
             m_registers.a += 0x06;
         }
     }
     else {
         // Previous operation was a subtraction
-        if (m_registers.f.c) {
+        if (getFlagC()) {
             m_registers.a -= 0x60;
         }
 
-        if (m_registers.f.h) {
+        if (getFlagH()) {
             m_registers.a -= 0x06;
         }
     }
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0x00);
-    m_registers.f.h = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagH(false);
+
+    m_cyclesToWait = 4;
 }
 
 // JR Z, r8
@@ -564,7 +1093,7 @@ void gbtest::LR35902::opcode28h()
 {
     const auto val = (int8_t) fetch();
 
-    if (!m_registers.f.z) {
+    if (!getFlagZ()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -618,8 +1147,8 @@ void gbtest::LR35902::opcode2Fh()
 {
     m_registers.a = ~m_registers.a;
 
-    m_registers.f.n = 1;
-    m_registers.f.h = 1;
+    setFlagN(true);
+    setFlagH(true);
 
     m_cyclesToWait = 4;
 }
@@ -629,7 +1158,7 @@ void gbtest::LR35902::opcode30h()
 {
     const auto val = (int8_t) fetch();
 
-    if (m_registers.f.c) {
+    if (getFlagC()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -666,9 +1195,9 @@ void gbtest::LR35902::opcode34h()
     const uint8_t val = m_bus.read(m_registers.hl, gbtest::BusRequestSource::CPU) + 1;
     m_bus.write(m_registers.hl, val, gbtest::BusRequestSource::CPU);
 
-    m_registers.f.z = val == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = (val == 0x00 || val == 0x10);
+    setFlagZFromResult(val);
+    setFlagN(false);
+    setFlagH((val == 0x00 || val == 0x10));
 
     m_cyclesToWait = 12;
 }
@@ -679,9 +1208,9 @@ void gbtest::LR35902::opcode35h()
     const uint8_t val = m_bus.read(m_registers.hl, gbtest::BusRequestSource::CPU) - 1;
     m_bus.write(m_registers.hl, val, gbtest::BusRequestSource::CPU);
 
-    m_registers.f.z = val == 0;
-    m_registers.f.n = 1;
-    m_registers.f.h = val == 0xF;
+    setFlagZFromResult(val);
+    setFlagN(true);
+    setFlagH(val == 0xF);
 
     m_cyclesToWait = 12;
 }
@@ -696,9 +1225,9 @@ void gbtest::LR35902::opcode36h()
 // SCF
 void gbtest::LR35902::opcode37h()
 {
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 1;
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(true);
 
     m_cyclesToWait = 4;
 }
@@ -708,7 +1237,7 @@ void gbtest::LR35902::opcode38h()
 {
     const auto val = (int8_t) fetch();
 
-    if (!m_registers.f.c) {
+    if (!getFlagC()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -760,9 +1289,9 @@ void gbtest::LR35902::opcode3Eh()
 // CCF
 void gbtest::LR35902::opcode3Fh()
 {
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = ~m_registers.f.c;
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(!getFlagC());
 
     m_cyclesToWait = 4;
 }
@@ -1148,8 +1677,14 @@ void gbtest::LR35902::opcode75h()
 // HALT
 void gbtest::LR35902::opcode76h()
 {
-    // TODO: Implement that
-    m_halted = true;
+    // With an interrupt already pending and IME reset, the CPU doesn't halt and reads the next byte twice (HALT bug)
+    if (!m_interruptController.isInterruptMasterEnabled() && m_interruptController.hasPendingInterrupt()) {
+        m_haltBug = true;
+    }
+    else {
+        m_halted = true;
+    }
+
     m_cyclesToWait = 4;
 }
 
@@ -1362,10 +1897,10 @@ void gbtest::LR35902::opcode97h()
     // No need to compute the values at runtime here
     m_registers.a = 0;
 
-    m_registers.f.z = 1;
-    m_registers.f.n = 1;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZ(true);
+    setFlagN(true);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 4;
 }
@@ -1614,10 +2149,10 @@ void gbtest::LR35902::opcodeBEh()
 // CP A, A
 void gbtest::LR35902::opcodeBFh()
 {
-    m_registers.f.z = 1;
-    m_registers.f.n = 1;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZ(true);
+    setFlagN(true);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 4;
 }
@@ -1625,7 +2160,7 @@ void gbtest::LR35902::opcodeBFh()
 // RET NZ
 void gbtest::LR35902::opcodeC0h()
 {
-    if (m_registers.f.z) {
+    if (getFlagZ()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -1648,7 +2183,7 @@ void gbtest::LR35902::opcodeC2h()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (m_registers.f.z) {
+    if (getFlagZ()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1669,7 +2204,7 @@ void gbtest::LR35902::opcodeC4h()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (m_registers.f.z) {
+    if (getFlagZ()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1712,7 +2247,7 @@ void gbtest::LR35902::opcodeC7h()
 // RET Z
 void gbtest::LR35902::opcodeC8h()
 {
-    if (!m_registers.f.z) {
+    if (!getFlagZ()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -1735,7 +2270,7 @@ void gbtest::LR35902::opcodeCAh()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (!m_registers.f.z) {
+    if (!getFlagZ()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1747,78 +2282,16 @@ void gbtest::LR35902::opcodeCAh()
 // Prefixed instructions
 void gbtest::LR35902::opcodeCBh()
 {
-    // Get the real opcode and the destination register/memory
-    const uint8_t opcode = fetch();
-    uint8_t lowOpcode = opcode & 0x7;
-
-    auto getRegisterByLowerBits = [&](const uint8_t& lowerBits, uint8_t& defaultDest) -> uint8_t& {
-        switch (lowerBits) {
-        case 0x00:
-            return m_registers.b;
-        case 0x01:
-            return m_registers.c;
-        case 0x02:
-            return m_registers.d;
-        case 0x03:
-            return m_registers.e;
-        case 0x04:
-            return m_registers.h;
-        case 0x05:
-            return m_registers.l;
-        case 0x07:
-            return m_registers.a;
-        default:
-            return defaultDest;
-        }
-    };
+    const uint8_t cbOpcode = fetch();
 
-    uint8_t memValue = m_bus.read(m_registers.hl, gbtest::BusRequestSource::CPU);
-    uint8_t& dest = getRegisterByLowerBits(lowOpcode, memValue);
-
-    // Apply the right operation
-    if (opcode >= 0x00 && opcode <= 0x07) {
-        RLC(dest);
-    }
-    else if (opcode >= 0x08 && opcode <= 0x0F) {
-        RRC(dest);
+#ifdef GBTEST_CPU_TRACE
+    // The prefix was traced before this fetch, the traced opcode becomes 100h + the prefixed one
+    if (m_trace != nullptr) {
+        m_trace->recordCBOpcode(cbOpcode);
     }
-    else if (opcode >= 0x10 && opcode <= 0x17) {
-        RL(dest);
-    }
-    else if (opcode >= 0x18 && opcode <= 0x1F) {
-        RR(dest);
-    }
-    else if (opcode >= 0x20 && opcode <= 0x27) {
-        SLA(dest);
-    }
-    else if (opcode >= 0x28 && opcode <= 0x2F) {
-        SRA(dest);
-    }
-    else if (opcode >= 0x30 && opcode <= 0x37) {
-        SWAP(dest);
-    }
-    else if (opcode >= 0x38 && opcode <= 0x3F) {
-        SRL(dest);
-    }
-    else if (opcode >= 0x40 && opcode <= 0x7F) {
-        BIT((opcode - 0x40) / 0x8, dest);
-    }
-    else if (opcode >= 0x80 && opcode <= 0xBF) {
-        RES((opcode - 0x80) / 0x8, dest);
-    }
-    else if (opcode >= 0xC0 && opcode <= 0xFF) {
-        SET((opcode - 0xC0) / 0x8, dest);
-    }
-
-    // If the low opcode was equal to 6, then the destination was the memory
-    if (lowOpcode == 0x06) {
-        if (opcode < 0x40 || opcode > 0x7F) {
-            // Only write the result if the operation was not BIT
-            m_bus.write(m_registers.hl, memValue, gbtest::BusRequestSource::CPU);
-        }
+#endif
 
-        m_cyclesToWait += 8;
-    }
+    executeCB(cbOpcode);
 }
 
 // CALL Z, a16
@@ -1826,7 +2299,7 @@ void gbtest::LR35902::opcodeCCh()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (!m_registers.f.z) {
+    if (!getFlagZ()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1873,7 +2346,7 @@ void gbtest::LR35902::opcodeCFh()
 // RET NC
 void gbtest::LR35902::opcodeD0h()
 {
-    if (m_registers.f.c) {
+    if (getFlagC()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -1896,7 +2369,7 @@ void gbtest::LR35902::opcodeD2h()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (m_registers.f.c) {
+    if (getFlagC()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1907,7 +2380,7 @@ void gbtest::LR35902::opcodeD2h()
 
 void gbtest::LR35902::opcodeD3h()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // CALL NC, a16
@@ -1915,7 +2388,7 @@ void gbtest::LR35902::opcodeD4h()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (m_registers.f.c) {
+    if (getFlagC()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1958,7 +2431,7 @@ void gbtest::LR35902::opcodeD7h()
 // RET C
 void gbtest::LR35902::opcodeD8h()
 {
-    if (!m_registers.f.c) {
+    if (!getFlagC()) {
         m_cyclesToWait = 8;
         return;
     }
@@ -1983,7 +2456,7 @@ void gbtest::LR35902::opcodeDAh()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (!m_registers.f.c) {
+    if (!getFlagC()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -1994,7 +2467,7 @@ void gbtest::LR35902::opcodeDAh()
 
 void gbtest::LR35902::opcodeDBh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // CALL C, a16
@@ -2002,7 +2475,7 @@ void gbtest::LR35902::opcodeDCh()
 {
     const uint16_t val = fetch() | (fetch() << 8);
 
-    if (!m_registers.f.c) {
+    if (!getFlagC()) {
         m_cyclesToWait = 12;
         return;
     }
@@ -2017,7 +2490,7 @@ void gbtest::LR35902::opcodeDCh()
 
 void gbtest::LR35902::opcodeDDh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // SBC A, d8
@@ -2062,12 +2535,12 @@ void gbtest::LR35902::opcodeE2h()
 
 void gbtest::LR35902::opcodeE3h()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 void gbtest::LR35902::opcodeE4h()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // PUSH HL
@@ -2084,10 +2557,10 @@ void gbtest::LR35902::opcodeE6h()
 {
     m_registers.a &= fetch();
 
-    m_registers.f.z = m_registers.a == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 1;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(true);
+    setFlagC(false);
 
     m_cyclesToWait = 8;
 }
@@ -2111,15 +2584,15 @@ void gbtest::LR35902::opcodeE8h()
     const uint32_t res = m_registers.sp + immediateValue;
 
     // Set the half-carry before doing anything as we need the current value in register A
-    m_registers.f.h = ((((m_registers.sp & 0x000F) + (immediateValue & 0x0F)) & 0x0010) == 0x0010);
-    m_registers.f.c = ((((m_registers.sp & 0x00FF) + (immediateValue & 0xFF)) & 0x0100) == 0x0100);
+    setFlagH(((((m_registers.sp & 0x000F) + (immediateValue & 0x0F)) & 0x0010) == 0x0010));
+    setFlagC(((((m_registers.sp & 0x00FF) + (immediateValue & 0xFF)) & 0x0100) == 0x0100));
 
     // Set the accumulator to the result
     m_registers.sp = (res & 0xFFFF);
 
     // Set the flags according to the result
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
+    setFlagZ(false);
+    setFlagN(false);
 
     m_cyclesToWait = 4;
 }
@@ -2140,17 +2613,17 @@ void gbtest::LR35902::opcodeEAh()
 
 void gbtest::LR35902::opcodeEBh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 void gbtest::LR35902::opcodeECh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 void gbtest::LR35902::opcodeEDh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // XOR A, d8
@@ -2158,10 +2631,10 @@ void gbtest::LR35902::opcodeEEh()
 {
     m_registers.a ^= fetch();
 
-    m_registers.f.z = m_registers.a == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 8;
 }
@@ -2189,6 +2662,8 @@ void gbtest::LR35902::opcodeF1h()
 {
     m_registers.af = (m_bus.read(m_registers.sp++, gbtest::BusRequestSource::CPU) & 0xF0)
             | (m_bus.read(m_registers.sp++, gbtest::BusRequestSource::CPU) << 8);
+    loadFlags();
+
     m_cyclesToWait = 12;
 }
 
@@ -2208,12 +2683,14 @@ void gbtest::LR35902::opcodeF3h()
 
 void gbtest::LR35902::opcodeF4h()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // PUSH AF
 void gbtest::LR35902::opcodeF5h()
 {
+    storeFlags();
+
     m_bus.write(--m_registers.sp, m_registers.af >> 8, gbtest::BusRequestSource::CPU);
     m_bus.write(--m_registers.sp, m_registers.af, gbtest::BusRequestSource::CPU);
 
@@ -2225,10 +2702,10 @@ void gbtest::LR35902::opcodeF6h()
 {
     m_registers.a |= fetch();
 
-    m_registers.f.z = m_registers.a == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 8;
 }
@@ -2250,10 +2727,10 @@ void gbtest::LR35902::opcodeF8h()
     auto a = (int8_t) fetch();
     m_registers.hl = m_registers.sp + a;
 
-    m_registers.f.z = 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = (((m_registers.sp & 0xF) + (a & 0xF)) & 0x10) == 0x10;
-    m_registers.f.c = (((m_registers.sp & 0xFF) + (a & 0xFF)) & 0x100) == 0x100;
+    setFlagZ(false);
+    setFlagN(false);
+    setFlagH((((m_registers.sp & 0xF) + (a & 0xF)) & 0x10) == 0x10);
+    setFlagC((((m_registers.sp & 0xFF) + (a & 0xFF)) & 0x100) == 0x100);
 
     m_cyclesToWait = 12;
 }
@@ -2282,12 +2759,12 @@ void gbtest::LR35902::opcodeFBh()
 
 void gbtest::LR35902::opcodeFCh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 void gbtest::LR35902::opcodeFDh()
 {
-    throw std::runtime_error("Opcode not implemented!");
+    executeIllegalOpcode();
 }
 
 // CP A, d8
@@ -2311,130 +2788,102 @@ void gbtest::LR35902::opcodeFFh()
 }
 
 // 0xCB-prefixed instructions
-void gbtest::LR35902::RLC(uint8_t& dest)
-{
-    m_registers.f.c = (dest >> 7) & 0x1;
-
-    dest = (dest << 1) | m_registers.f.c;
-
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::RRC(uint8_t& dest)
+template<uint8_t cbOpcode>
+void gbtest::LR35902::executeCBOpcode()
 {
-    m_registers.f.c = dest & 0x1;
+    constexpr CBOperation operation = getCBOperation(cbOpcode);
+    constexpr uint8_t bitIndex = getCBBitIndex(cbOpcode);
+    constexpr uint8_t operandIndex = getCBOperandIndex(cbOpcode);
 
-    dest = (dest >> 1) | (m_registers.f.c << 7);
+    if constexpr (operandIndex == 0x6) {
+        // (HL), BIT doesn't write the result back
+        const uint8_t result = applyCBOperation<operation, bitIndex>(m_bus.read(m_registers.hl, gbtest::BusRequestSource::CPU));
 
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::RL(uint8_t& dest)
-{
-    const uint8_t newCarry = (dest >> 7) & 0x1;
-
-    dest = (dest << 1) | (m_registers.f.c & 0x1);
-
-    m_registers.f.z = (dest == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = newCarry;
-
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::RR(uint8_t& dest)
-{
-    const uint8_t newCarry = dest & 0x1;
-
-    dest = (dest >> 1) | (m_registers.f.c << 7);
-
-    m_registers.f.z = (dest == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = newCarry;
-
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::SLA(uint8_t& dest)
-{
-    m_registers.f.c = (dest >> 7) & 0x1;
-
-    dest <<= 1;
-
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
+        if constexpr (operation != CBOperation::BIT) {
+            m_bus.write(m_registers.hl, result, gbtest::BusRequestSource::CPU);
+        }
+    }
+    else {
+        uint8_t& reg = getCBOperandRegister<operandIndex>();
+        reg = applyCBOperation<operation, bitIndex>(reg);
+    }
 
-    m_cyclesToWait = 8;
+    m_cyclesToWait = s_cbOpcodeCycles[cbOpcode];
 }
 
-void gbtest::LR35902::SRA(uint8_t& dest)
+template<uint8_t operandIndex>
+uint8_t& gbtest::LR35902::getCBOperandRegister()
 {
-    m_registers.f.c = dest & 0x1;
-
-    dest >>= 1;
-    dest |= (dest & 0x40) << 1;
+    static_assert(operandIndex < 0x8 && operandIndex != 0x6, "(HL) is not a register");
 
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-
-    m_cyclesToWait = 8;
+    if constexpr (operandIndex == 0x0) { return m_registers.b; }
+    else if constexpr (operandIndex == 0x1) { return m_registers.c; }
+    else if constexpr (operandIndex == 0x2) { return m_registers.d; }
+    else if constexpr (operandIndex == 0x3) { return m_registers.e; }
+    else if constexpr (operandIndex == 0x4) { return m_registers.h; }
+    else if constexpr (operandIndex == 0x5) { return m_registers.l; }
+    else { return m_registers.a; }
 }
 
-void gbtest::LR35902::SWAP(uint8_t& dest)
+template<gbtest::CBOperation operation, uint8_t bitIndex>
+uint8_t gbtest::LR35902::applyCBOperation(uint8_t value)
 {
-    const uint8_t newUpper = dest << 4;
-    dest = (dest >> 4) | newUpper;
-
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    // BIT, RES and SET leave the other flags alone
+    if constexpr (operation == CBOperation::BIT) {
+        setFlagZFromResult(value & (1 << bitIndex));
+        setFlagN(false);
+        setFlagH(true);
 
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::SRL(uint8_t& dest)
-{
-    m_registers.f.c = dest & 0x1;
-
-    dest >>= 1;
-
-    m_registers.f.z = dest == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-
-    m_cyclesToWait = 8;
-}
-
-void gbtest::LR35902::BIT(const uint8_t& bitToTest, const uint8_t& src)
-{
-    m_registers.f.z = (src & (1 << bitToTest)) == 0;
-    m_registers.f.n = 0;
-    m_registers.f.h = 1;
+        return value;
+    }
+    else if constexpr (operation == CBOperation::RES) {
+        return value & ~(1 << bitIndex);
+    }
+    else if constexpr (operation == CBOperation::SET) {
+        return value | (1 << bitIndex);
+    }
+    else {
+        uint8_t result;
 
-    m_cyclesToWait = 8;
-}
+        if constexpr (operation == CBOperation::RLC) {
+            result = (value << 1) | (value >> 7);
+            setFlagC(value >> 7);
+        }
+        else if constexpr (operation == CBOperation::RRC) {
+            result = (value >> 1) | (value << 7);
+            setFlagC(value & 0x1);
+        }
+        else if constexpr (operation == CBOperation::RL) {
+            result = (value << 1) | getFlagC();
+            setFlagC(value >> 7);
+        }
+        else if constexpr (operation == CBOperation::RR) {
+            result = (value >> 1) | (getFlagC() << 7);
+            setFlagC(value & 0x1);
+        }
+        else if constexpr (operation == CBOperation::SLA) {
+            result = value << 1;
+            setFlagC(value >> 7);
+        }
+        else if constexpr (operation == CBOperation::SRA) {
+            result = (value >> 1) | (value & 0x80);
+            setFlagC(value & 0x1);
+        }
+        else if constexpr (operation == CBOperation::SWAP) {
+            result = (value >> 4) | (value << 4);
+            setFlagC(false);
+        }
+        else {
+            result = value >> 1;
+            setFlagC(value & 0x1);
+        }
 
-void gbtest::LR35902::RES(const uint8_t& bitToClear, uint8_t& dest)
-{
-    dest &= ~(1 << bitToClear);
-}
+        setFlagZFromResult(result);
+        setFlagN(false);
+        setFlagH(false);
 
-void gbtest::LR35902::SET(const uint8_t& bitToSet, uint8_t& dest)
-{
-    dest |= 1 << bitToSet;
+        return result;
+    }
 }
 
 void gbtest::LR35902::ADD_A(const uint8_t& src)
@@ -2442,68 +2891,73 @@ void gbtest::LR35902::ADD_A(const uint8_t& src)
     // First compute the final result
     const uint16_t res = m_registers.a + src;
 
-    // Set the half-carry before doing anything as we need the current value in register A
-    m_registers.f.h = ((((m_registers.a & 0x0F) + (src & 0x0F)) & 0x10) == 0x10);
+    // Set the (half-)carry before doing anything as we need the current value in register A
+    setFlagHFromOperation(m_registers.a, src, res);
+    setFlagCFromResult(res);
 
     // Set the accumulator to the result
     m_registers.a = res;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 0;
-    m_registers.f.c = (res > 0xFF);
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
 
     m_cyclesToWait = 4;
 }
 
 void gbtest::LR35902::ADC_A(const uint8_t& src)
 {
-    // First compute the final result
-    const uint16_t res = m_registers.a + src + m_registers.f.c;
+    // First compute the final result, the half-carry takes the carry into account too
+    const uint16_t res = m_registers.a + src + getFlagC();
 
-    // We must compute the operation separately to set the half-carry properly
-    m_registers.f.h = ((((m_registers.a & 0x0F) + (src & 0x0F) + (m_registers.f.c & 0x0F)) & 0x10) == 0x10);
+    // Set the (half-)carry before doing anything as we need the current value in register A
+    setFlagHFromOperation(m_registers.a, src, res);
+    setFlagCFromResult(res);
 
     // Set the accumulator to the result
     m_registers.a = res;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 0;
-    m_registers.f.c = (res > 0xFF);
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
 
     m_cyclesToWait = 4;
 }
 
 void gbtest::LR35902::SUB_A(const uint8_t& src)
 {
-    // Set (half-)carry flags before the operation takes place
-    m_registers.f.h = (src & 0x0F) > (m_registers.a & 0x0F);
-    m_registers.f.c = (src > m_registers.a);
+    // First compute the final result, a borrow sets its upper bits
+    const uint16_t res = m_registers.a - src;
+
+    // Set the (half-)carry before doing anything as we need the current value in register A
+    setFlagHFromOperation(m_registers.a, src, res);
+    setFlagCFromResult(res);
 
     // Set the accumulator to the result
-    m_registers.a -= src;
+    m_registers.a = res;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 1;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(true);
 
     m_cyclesToWait = 4;
 }
 
 void gbtest::LR35902::SBC_A(const uint8_t& src)
 {
+    // First compute the final result, a borrow sets its upper bits
+    const uint16_t res = m_registers.a - src - getFlagC();
+
     // Set the (half-)carry before doing anything as we need the current value in register A
-    const uint8_t oldCarry = m_registers.f.c;
-    m_registers.f.h = (((src & 0x0F) + (oldCarry & 0x0F))) > (m_registers.a & 0x0F);
-    m_registers.f.c = ((src + oldCarry) > m_registers.a);
+    setFlagHFromOperation(m_registers.a, src, res);
+    setFlagCFromResult(res);
 
     // Set the accumulator to the result
-    m_registers.a -= src + oldCarry;
+    m_registers.a = res;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 1;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(true);
 
     m_cyclesToWait = 4;
 }
@@ -2514,10 +2968,10 @@ void gbtest::LR35902::AND_A(const uint8_t& src)
     m_registers.a &= src;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = 1;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(true);
+    setFlagC(false);
 
     m_cyclesToWait = 4;
 }
@@ -2528,10 +2982,10 @@ void gbtest::LR35902::XOR_A(const uint8_t& src)
     m_registers.a ^= src;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 4;
 }
@@ -2542,21 +2996,24 @@ void gbtest::LR35902::OR_A(const uint8_t& src)
     m_registers.a |= src;
 
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = 0;
-    m_registers.f.c = 0;
+    setFlagZFromResult(m_registers.a);
+    setFlagN(false);
+    setFlagH(false);
+    setFlagC(false);
 
     m_cyclesToWait = 4;
 }
 
 void gbtest::LR35902::CP_A(const uint8_t& src)
 {
+    // Same as SUB_A, without keeping the result
+    const uint16_t res = m_registers.a - src;
+
     // Set the flags according to the result
-    m_registers.f.z = (m_registers.a == src);
-    m_registers.f.n = 1;
-    m_registers.f.h = ((src & 0x0F) > (m_registers.a & 0x0F));
-    m_registers.f.c = (src > m_registers.a);
+    setFlagZFromResult(res);
+    setFlagN(true);
+    setFlagHFromOperation(m_registers.a, src, res);
+    setFlagCFromResult(res);
 
     m_cyclesToWait = 4;
 }
@@ -2564,12 +3021,12 @@ void gbtest::LR35902::CP_A(const uint8_t& src)
 void gbtest::LR35902::INC_r8(uint8_t& reg)
 {
     // Increment the register
-    uint8_t oldVal = reg++;
+    const uint8_t oldVal = reg++;
 
     // Set the flags according to the result
-    m_registers.f.z = (reg == 0);
-    m_registers.f.n = 0;
-    m_registers.f.h = ((oldVal & 0x08) && !(reg & 0x08));
+    setFlagZFromResult(reg);
+    setFlagN(false);
+    setFlagHFromOperation(oldVal, 1, reg);
 
     m_cyclesToWait = 4;
 }
@@ -2577,26 +3034,58 @@ void gbtest::LR35902::INC_r8(uint8_t& reg)
 void gbtest::LR35902::DEC_r8(uint8_t& reg)
 {
     // Decrement the register
-    uint8_t oldVal = reg--;
+    const uint8_t oldVal = reg--;
 
     // Set the flags according to the result
-    m_registers.f.z = (reg == 0);
-    m_registers.f.n = 1;
-    m_registers.f.h = ((oldVal & 0x10) != (reg & 0x10));
+    setFlagZFromResult(reg);
+    setFlagN(true);
+    setFlagHFromOperation(oldVal, 1, reg);
 
     m_cyclesToWait = 4;
 }
 
 void gbtest::LR35902::ADD_HL_r16(uint16_t& reg)
 {
-    // Add the value of the specified register to HL
-    uint16_t oldVal = m_registers.hl;
-    m_registers.hl += reg;
+    // First compute the final result
+    const uint32_t res = m_registers.hl + reg;
 
-    // Set the flags according to the result
-    m_registers.f.n = 0;
-    m_registers.f.h = ((((oldVal & 0x0FFF) + (reg & 0x0FFF)) & 0x1000) == 0x1000);
-    m_registers.f.c = ((((oldVal & 0xFFFF) + (reg & 0xFFFF)) & 0x10000) == 0x10000);
+    // Set the flags according to the result, the carries into bits 12 and 16 are the ones into bits 4 and 8 of the upper byte
+    setFlagN(false);
+    setFlagHFromOperation(m_registers.hl >> 8, reg >> 8, res >> 8);
+    setFlagCFromResult(res >> 8);
+
+    // Add the value of the specified register to HL
+    m_registers.hl = res;
 
     m_cyclesToWait = 8;
+}
+
+void gbtest::LR35902::saveState(StateWriter& writer) const
+{
+    storeFlags();
+
+    writer.write(m_registers);
+    writer.write(m_cyclesToWait);
+    writer.write(m_halted);
+    writer.write(m_stopped);
+    writer.write(m_haltBug);
+    writer.write(m_tickCounter);
+
+    m_interruptController.saveState(writer);
+}
+
+void gbtest::LR35902::loadState(StateReader& reader)
+{
+    reader.read(m_registers);
+    loadFlags();
+    reader.read(m_cyclesToWait);
+    reader.read(m_halted);
+    reader.read(m_stopped);
+    reader.read(m_haltBug);
+    reader.read(m_tickCounter);
+
+    m_interruptController.loadState(reader);
+
+    // The memory is loaded behind the bus' back, the decoded blocks may not match it anymore
+    flushBlockCache();
 }
\ No newline at end of file
@@ -3,15 +3,31 @@
 
 #include <array>
 #include <cstdint>
-#include <functional>
+#include <memory>
 #include <vector>
 
 #include "../platform/bus/Bus.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
 #include "../utils/Tickable.h"
 
+#include "decoder/CBOperation.h"
+#include "decoder/DecodedBlockCache.h"
 #include "interrupts/InterruptController.h"
 #include "LR35902Registers.h"
 
+#ifdef GBTEST_CPU_JIT
+#include "jit/JitCompiler.h"
+#endif
+
+#ifdef GBTEST_CPU_PROFILER
+#include "profiler/CpuProfiler.h"
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+#include "trace/InstructionTrace.h"
+#endif
+
 namespace gbtest {
 
 class LR35902
@@ -39,27 +55,120 @@ public:
     [[nodiscard]] const uint8_t& getCyclesToWaste() const;
     [[nodiscard]] const unsigned& getTickCounter() const;
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     void tick() override;
     void step();
+    void wasteCycles(uint8_t cycleCount);
+
+    /*
+     * Run whole instructions back to back, advancing the scheduler, until the cycle count is reached
+     * or the next instruction would start after the next scheduled device event
+     * While halted, the cycles up to the next scheduled device event are skipped at once
+     * Returns the cycles consumed, the devices must be synchronized before calling it again when it stopped early
+     */
+    uint64_t runFor(uint64_t cycleCount);
+
+    void setBlockCacheEnabled(bool enabled); // Enabled by default
+    [[nodiscard]] bool isBlockCacheEnabled() const;
+    void flushBlockCache(); // After memory holding code was changed behind the bus' back
+
+    [[nodiscard]] size_t getOwnedMemorySize() const; // Bytes allocated by the caches
+
+#ifdef GBTEST_CPU_JIT
+    void setJitEnabled(bool enabled); // Ignored on the hosts the JIT doesn't support
+    [[nodiscard]] bool isJitEnabled() const;
+#endif
+
+#ifdef GBTEST_CPU_PROFILER
+    void setProfiler(CpuProfiler* profiler); // nullptr to stop profiling
+    [[nodiscard]] CpuProfiler* getProfiler() const;
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+    void setTrace(InstructionTrace* trace); // nullptr to stop tracing, the JIT is left aside while tracing
+    [[nodiscard]] InstructionTrace* getTrace() const;
+#endif
 
 private:
+    void executeInstruction();
+    void executeIllegalOpcode();
+    bool shouldWakeUp();
     uint8_t fetch();
+    uint8_t fetchOpcode(); // Like fetch(), with the HALT bug
+    void execute(uint8_t opcode);
+    void executeCB(uint8_t cbOpcode);
 
     Bus& m_bus;
 
-    const std::array<std::function<void()>, 0x100> m_opcodeLookup;
-
     InterruptController m_interruptController;
     void handleInterrupt();
 
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    mutable LR35902Registers m_registers; // F is only brought up to date when the registers are looked at
+#else
     LR35902Registers m_registers;
+#endif
+
+#ifdef GBTEST_CPU_LAZY_FLAGS
+    // What the flags are computed from when read, the ALU stores these instead of updating the F bits one by one
+    uint8_t m_flagZResult;  // Z is set when it is 0
+    bool m_flagN;
+    uint8_t m_flagHBits;    // H is its bit 4 (operands and result XORed together, for the carry into bit 4)
+    uint16_t m_flagCBits;   // C is its bit 8 (carry or borrow out of bit 7)
+#endif
+
+    [[nodiscard]] bool getFlagZ() const;
+    [[nodiscard]] bool getFlagN() const;
+    [[nodiscard]] bool getFlagH() const;
+    [[nodiscard]] bool getFlagC() const;
+    void setFlagZ(bool z);
+    void setFlagN(bool n);
+    void setFlagH(bool h);
+    void setFlagC(bool c);
+    void setFlagZFromResult(uint8_t result);
+    void setFlagHFromOperation(unsigned lhs, unsigned rhs, unsigned result); // Carry (or borrow) into bit 4
+    void setFlagCFromResult(unsigned result);                               // Carry (or borrow) out of bit 7
+    [[nodiscard]] uint8_t getFlags() const; // F with the current flags, without writing them to it
+    void storeFlags() const; // Write the flags to F (F is always up to date without lazy flags)
+    void loadFlags();        // Take the flags from F, after F was written directly
 
     uint8_t m_cyclesToWait;
     bool m_halted; // CPU halted state
     bool m_stopped; // CPU stopped state
+    bool m_haltBug; // The next opcode is fetched without incrementing PC (HALT with an interrupt pending and IME reset)
 
     unsigned m_tickCounter;
 
+    using OpcodeHandler = void (*)(LR35902* cpu);
+
+    static const OpcodeHandler s_opcodeHandlers[0x100]; // The opcode handlers as plain functions, for the block runners
+
+    std::unique_ptr<DecodedBlockCache> m_blockCache;
+    const uint8_t* m_decodedOperands; // Operands of the decoded instruction being run, nullptr to fetch from the bus
+    bool runDecodedBlock(uint64_t targetCycle);
+
+    bool canRunBlock();
+    [[nodiscard]] uint64_t getBlockLimitCycle(uint64_t targetCycle) const;
+
+#ifdef GBTEST_CPU_JIT
+    friend class JitCompiler;
+
+    std::unique_ptr<JitCompiler> m_jit;
+    bool runJitBlock(uint64_t targetCycle);
+#endif
+
+#ifdef GBTEST_CPU_PROFILER
+    CpuProfiler* m_profiler;
+    void profileInstruction(uint8_t opcode, uint16_t pc, uint16_t sp);
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+    InstructionTrace* m_trace;
+    void traceInstruction(uint16_t pc, uint8_t opcode, uint64_t cycle); // opcodeCBh() adds the prefixed opcode
+#endif
+
     // Opcodes
     void opcode00h();
     void opcode01h();
@@ -318,18 +427,13 @@ private:
     void opcodeFEh();
     void opcodeFFh();
 
-    // For 0xCB-prefixed instructions
-    void RLC(uint8_t& dest);
-    void RRC(uint8_t& dest);
-    void RL(uint8_t& dest);
-    void RR(uint8_t& dest);
-    void SLA(uint8_t& dest);
-    void SRA(uint8_t& dest);
-    void SWAP(uint8_t& dest);
-    void SRL(uint8_t& dest);
-    void BIT(const uint8_t& bitToTest, const uint8_t& src);
-    void RES(const uint8_t& bitToClear, uint8_t& dest);
-    void SET(const uint8_t& bitToSet, uint8_t& dest);
+    // For 0xCB-prefixed instructions, one handler per opcode with the operation, bit and operand known at compile time
+    template<uint8_t cbOpcode>
+    void executeCBOpcode();
+    template<uint8_t operandIndex>
+    uint8_t& getCBOperandRegister();
+    template<CBOperation operation, uint8_t bitIndex>
+    uint8_t applyCBOperation(uint8_t value);
 
     // Common instructions
     void ADD_A(const uint8_t& src);
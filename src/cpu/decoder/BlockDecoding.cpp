@@ -0,0 +1,58 @@
+#include "BlockDecoding.h"
+
+namespace {
+
+// Instruction lengths, 0 for STOP, HALT and the illegal opcodes
+constexpr uint8_t s_instructionLengths[0x100] = {
+        1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1, // 0x
+        0, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 1x
+        2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 2x
+        2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1, // 3x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 4x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 5x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 6x
+        1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 7x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 8x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 9x
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Ax
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // Bx
+        1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1, // Cx
+        1, 1, 3, 0, 3, 1, 2, 1, 1, 1, 3, 0, 3, 0, 2, 1, // Dx
+        2, 1, 1, 0, 0, 1, 2, 1, 2, 1, 3, 0, 0, 0, 2, 1, // Ex
+        2, 1, 1, 1, 0, 1, 2, 1, 2, 1, 3, 1, 0, 0, 2, 1, // Fx
+};
+
+} // namespace
+
+size_t gbtest::BlockDecoding::getInstructionLength(uint8_t opcode)
+{
+    return s_instructionLengths[opcode];
+}
+
+bool gbtest::BlockDecoding::isBlockEnd(uint8_t opcode, uint8_t cbOpcode)
+{
+    switch (opcode) {
+    case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:                  // JR
+    case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA: case 0xE9:       // JP
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:                  // CALL
+    case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9:       // RET and RETI
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+    case 0xFB:                                                              // EI
+        return true;
+
+    // Memory writes
+    case 0x02: case 0x12: case 0x22: case 0x32:                             // LD (BC), A ... LD (HL-), A
+    case 0x34: case 0x35: case 0x36:                                        // INC (HL), DEC (HL), LD (HL), d8
+    case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x77: // LD (HL), r
+    case 0x08: case 0xE0: case 0xE2: case 0xEA:                             // LD (a16), SP, LDH and LD (a16), A
+    case 0xC5: case 0xD5: case 0xE5: case 0xF5:                             // PUSH
+        return true;
+
+    case 0xCB:
+        // Every operation on (HL) but BIT writes it back
+        return (cbOpcode & 0x07) == 0x06 && (cbOpcode < 0x40 || cbOpcode >= 0x80);
+
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef GBTEST_BLOCKDECODING_H
+#define GBTEST_BLOCKDECODING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Basic block rules shared by the decoded block cache and the JIT
+ * A block ends with the first branch, call, return, restart or EI, and right after the first memory write
+ * (which may reschedule a device, request an interrupt, switch a bank or modify code)
+ * HALT, STOP and the illegal opcodes are never part of a block, the interpreter handles them
+ */
+namespace gbtest::BlockDecoding {
+
+[[nodiscard]] size_t getInstructionLength(uint8_t opcode); // 0 for the opcodes that are never part of a block
+[[nodiscard]] bool isBlockEnd(uint8_t opcode, uint8_t cbOpcode); // cbOpcode is only looked at for CBh
+
+} // namespace gbtest::BlockDecoding
+
+#endif //GBTEST_BLOCKDECODING_H
@@ -0,0 +1,52 @@
+#ifndef GBTEST_CBOPERATION_H
+#define GBTEST_CBOPERATION_H
+
+#include <cstdint>
+
+namespace gbtest {
+
+enum class CBOperation {
+    RLC,    // Rotate left
+    RRC,    // Rotate right
+    RL,     // Rotate left through the carry
+    RR,     // Rotate right through the carry
+    SLA,    // Shift left
+    SRA,    // Shift right, keeping bit 7
+    SWAP,   // Swap the nibbles
+    SRL,    // Shift right
+    BIT,    // Test a bit
+    RES,    // Clear a bit
+    SET,    // Set a bit
+}; // enum class CBOperation
+
+/*
+ * 0xCB-prefixed opcodes are laid out as 2 bits of group, 3 bits of operation or bit index, and 3 bits of operand
+ * (B, C, D, E, H, L, (HL), A), the group 0 being the rotates and shifts
+ */
+[[nodiscard]] constexpr CBOperation getCBOperation(uint8_t cbOpcode)
+{
+    switch (cbOpcode >> 6) {
+    case 0x0:
+        return static_cast<CBOperation>(cbOpcode >> 3);
+    case 0x1:
+        return CBOperation::BIT;
+    case 0x2:
+        return CBOperation::RES;
+    default:
+        return CBOperation::SET;
+    }
+}
+
+[[nodiscard]] constexpr uint8_t getCBBitIndex(uint8_t cbOpcode)
+{
+    return (cbOpcode >> 3) & 0x7;
+}
+
+[[nodiscard]] constexpr uint8_t getCBOperandIndex(uint8_t cbOpcode)
+{
+    return cbOpcode & 0x7;
+}
+
+} // namespace gbtest
+
+#endif //GBTEST_CBOPERATION_H
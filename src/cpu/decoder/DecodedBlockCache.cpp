@@ -0,0 +1,141 @@
+#include "BlockDecoding.h"
+#include "DecodedBlockCache.h"
+
+gbtest::DecodedBlockCache::DecodedBlockCache(Bus& bus, const Handler* handlers)
+        : m_bus(bus)
+        , m_handlers(handlers)
+        , m_blockTags(s_blockCacheSize, BlockTag{nullptr, 0, false})
+        , m_blocks(s_blockCacheSize, Block{0, {}})
+        , m_pageBlockCounts()
+        , m_decodedBlockCount(0)
+{
+    m_bus.setWriteWatcher(this);
+}
+
+gbtest::DecodedBlockCache::~DecodedBlockCache()
+{
+    // Stop watching the pages before the bus is left without a watcher
+    flush();
+    m_bus.setWriteWatcher(nullptr);
+}
+
+const gbtest::DecodedBlockCache::Block* gbtest::DecodedBlockCache::getBlock(uint16_t pc)
+{
+    // The I/O page and the code that isn't plain memory are always interpreted
+    const uint8_t* hostCode = (pc < 0xFF00) ? m_bus.getReadMemory(pc) : nullptr;
+
+    if (hostCode == nullptr) { return nullptr; }
+
+    // Find the block (blocks are dropped as soon as their code may have changed)
+    const uintptr_t hostAddress = reinterpret_cast<uintptr_t>(hostCode);
+    const size_t blockIndex = (hostAddress ^ (hostAddress >> 10)) & (s_blockCacheSize - 1);
+    BlockTag& blockTag = m_blockTags[blockIndex];
+
+    // Only decode the code running again, decoding straight-line code running once costs more than interpreting it
+    if (blockTag.hostCode != hostCode || blockTag.pc != pc) {
+        if (blockTag.decoded) {
+            freeBlock(blockIndex);
+        }
+
+        blockTag = {hostCode, pc, false};
+        return nullptr;
+    }
+
+    // Decode it on its second run, or try again if the first instruction can't be decoded (it's never cached)
+    if (!blockTag.decoded) {
+        decodeBlock(blockIndex);
+    }
+
+    return blockTag.decoded ? &m_blocks[blockIndex] : nullptr;
+}
+
+void gbtest::DecodedBlockCache::flush()
+{
+    for (size_t blockIndex = 0; blockIndex < s_blockCacheSize && m_decodedBlockCount > 0; ++blockIndex) {
+        if (m_blockTags[blockIndex].decoded) {
+            freeBlock(blockIndex);
+        }
+    }
+}
+
+size_t gbtest::DecodedBlockCache::getDecodedBlockCount() const
+{
+    return m_decodedBlockCount;
+}
+
+size_t gbtest::DecodedBlockCache::getOwnedMemorySize() const
+{
+    return sizeof(DecodedBlockCache) + m_blockTags.capacity() * sizeof(BlockTag) + m_blocks.capacity() * sizeof(Block);
+}
+
+void gbtest::DecodedBlockCache::onWatchedWrite(uint16_t addr)
+{
+    // Blocks never cross a page, only the ones of the written page may be stale
+    const uint8_t page = addr >> 8;
+
+    for (size_t blockIndex = 0; blockIndex < s_blockCacheSize && m_pageBlockCounts[page] > 0; ++blockIndex) {
+        const BlockTag& blockTag = m_blockTags[blockIndex];
+
+        if (blockTag.decoded && (blockTag.pc >> 8) == page) {
+            freeBlock(blockIndex);
+        }
+    }
+}
+
+void gbtest::DecodedBlockCache::decodeBlock(size_t blockIndex)
+{
+    BlockTag& blockTag = m_blockTags[blockIndex];
+    Block& block = m_blocks[blockIndex];
+
+    // The block stays in the page of its first instruction, which the host code address was looked up from
+    const uint8_t* hostCode = blockTag.hostCode;
+    const size_t pageEnd = 0x100 - (blockTag.pc & 0xFF);
+    size_t size = 0;
+    size_t instructionCount = 0;
+
+    while (instructionCount < s_maxBlockInstructionCount) {
+        const uint8_t opcode = hostCode[size];
+        const size_t length = BlockDecoding::getInstructionLength(opcode);
+
+        if (length == 0 || size + length > pageEnd) { break; }
+
+        Instruction& instruction = block.instructions[instructionCount];
+        instruction.handler = m_handlers[opcode];
+        instruction.nextPc = static_cast<uint16_t>(blockTag.pc + size + 1);
+        instruction.operands[0] = (length > 1) ? hostCode[size + 1] : 0x00;
+        instruction.operands[1] = (length > 2) ? hostCode[size + 2] : 0x00;
+        instruction.opcode = opcode;
+
+        size += length;
+        ++instructionCount;
+
+        if (BlockDecoding::isBlockEnd(opcode, instruction.operands[0])) { break; }
+    }
+
+    if (instructionCount == 0) { return; }
+
+    block.instructionCount = static_cast<uint8_t>(instructionCount);
+    blockTag.decoded = true;
+    ++m_decodedBlockCount;
+
+    // Writes to the page must drop its blocks from now on, unless it can't be written to (ROM)
+    const uint8_t page = blockTag.pc >> 8;
+
+    if (m_pageBlockCounts[page]++ == 0 && m_bus.isPageWritable(page)) {
+        m_bus.setPageWriteWatched(page, true);
+    }
+}
+
+void gbtest::DecodedBlockCache::freeBlock(size_t blockIndex)
+{
+    BlockTag& blockTag = m_blockTags[blockIndex];
+    const uint8_t page = blockTag.pc >> 8;
+
+    // The instructions are left as they are, the CPU may still be running the block that wrote to its page
+    blockTag = {nullptr, 0, false};
+    --m_decodedBlockCount;
+
+    if (--m_pageBlockCounts[page] == 0) {
+        m_bus.setPageWriteWatched(page, false);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef GBTEST_DECODEDBLOCKCACHE_H
+#define GBTEST_DECODEDBLOCKCACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../platform/bus/Bus.h"
+#include "../../platform/bus/BusWriteWatcher.h"
+
+namespace gbtest {
+
+class LR35902;
+
+/*
+ * Guest basic blocks decoded once for the interpreter: the handler of each instruction and the bytes following
+ * its opcode, so that straight-line code runs without fetching and dispatching every byte again
+ * Blocks follow the rules of BlockDecoding and stay in the page of their first instruction, the I/O page excepted
+ * They are cached by host code address and PC, which tells the ROM banks apart, and decoded the second time they
+ * are found at the same place (straight-line code running once is interpreted). ROM never changes, the writes to
+ * the pages of writable memory holding blocks are reported by the bus and drop every block of the page
+ */
+class DecodedBlockCache
+        : public BusWriteWatcher {
+
+public:
+    using Handler = void (*)(LR35902* cpu);
+
+    static constexpr size_t s_maxBlockInstructionCount = 16;
+
+    struct Instruction {
+        Handler handler;
+        uint16_t nextPc;                    // Address following the opcode
+        std::array<uint8_t, 2> operands;    // Bytes following the opcode, for the handler to fetch
+        uint8_t opcode;                     // For the instruction trace
+    }; // struct Instruction
+
+    struct Block {
+        uint8_t instructionCount;
+        std::array<Instruction, s_maxBlockInstructionCount> instructions;
+    }; // struct Block
+
+    DecodedBlockCache(Bus& bus, const Handler* handlers);
+    ~DecodedBlockCache() override;
+
+    DecodedBlockCache(const DecodedBlockCache&) = delete;
+    DecodedBlockCache& operator=(const DecodedBlockCache&) = delete;
+
+    [[nodiscard]] const Block* getBlock(uint16_t pc); // nullptr if the instruction at PC must be interpreted
+    void flush(); // After memory holding blocks was changed behind the bus' back
+
+    [[nodiscard]] size_t getDecodedBlockCount() const;
+    [[nodiscard]] size_t getOwnedMemorySize() const;
+
+    void onWatchedWrite(uint16_t addr) override;
+
+private:
+    static constexpr size_t s_blockCacheSize = 0x400; // Must be a power of 2
+
+    // Looked up at every instruction boundary, kept apart from the decoded instructions to stay in the data cache
+    struct BlockTag {
+        const uint8_t* hostCode;            // nullptr if the cache entry is free
+        uint16_t pc;
+        bool decoded;                       // False until the block runs again, or if it can't be decoded
+    }; // struct BlockTag
+
+    Bus& m_bus;
+    const Handler* m_handlers;
+
+    std::vector<BlockTag> m_blockTags;
+    std::vector<Block> m_blocks;
+    std::array<uint16_t, 0xFF> m_pageBlockCounts; // Decoded blocks in each page, the page is watched meanwhile
+    size_t m_decodedBlockCount;
+
+    void decodeBlock(size_t blockIndex);
+    void freeBlock(size_t blockIndex);
+
+}; // class DecodedBlockCache
+
+} // namespace gbtest
+
+#endif //GBTEST_DECODEDBLOCKCACHE_H
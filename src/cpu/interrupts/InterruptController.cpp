@@ -6,7 +6,6 @@ gbtest::InterruptController::InterruptController(Bus& bus)
         , m_interruptEnable(0)
         , m_interruptFlag(0)
         , m_bus(bus)
-        , m_previousInterruptLines(0)
 {
 
 }
@@ -26,10 +25,15 @@ void gbtest::InterruptController::setDelayedInterruptEnableCountdown(int delayed
     m_delayedInterruptEnableCountdown = delayedInterruptEnableCountdown;
 }
 
+bool gbtest::InterruptController::hasDelayedInterruptEnable() const
+{
+    return m_delayedInterruptEnableCountdown > 0;
+}
+
 void gbtest::InterruptController::handleDelayedInterrupt()
 {
-    // Enable the interrupt if the countdown is at 0
-    if (m_delayedInterruptEnableCountdown >= 0) {
+    // Enable the interrupt if the countdown is at 0 (it stays there, instead of counting down forever)
+    if (m_delayedInterruptEnableCountdown > 0) {
         if (--m_delayedInterruptEnableCountdown == 0) {
             m_interruptMasterEnable = true;
         }
@@ -76,13 +80,15 @@ uint8_t gbtest::InterruptController::getInterruptRequest() const
     return m_interruptFlag;
 }
 
-void gbtest::InterruptController::tick()
+bool gbtest::InterruptController::hasPendingInterrupt() const
 {
-    // Detect which interrupt lines became high at this tick, and set the Interrupt Flag register accordingly
-    uint8_t interruptLines = m_bus.getInterruptLines();
+    return (m_interruptFlag & m_interruptEnable & 0x1F) != 0;
+}
 
-    m_interruptFlag |= (m_previousInterruptLines ^ interruptLines) & interruptLines;
-    m_previousInterruptLines = interruptLines;
+void gbtest::InterruptController::tick()
+{
+    // Set the Interrupt Flag register for every interrupt line that became high since the last tick
+    m_interruptFlag |= m_bus.takeRaisedInterruptLines();
 }
 
 bool gbtest::InterruptController::busRead(uint16_t addr, uint8_t& val, gbtest::BusRequestSource requestSource) const
@@ -131,3 +137,38 @@ bool gbtest::InterruptController::busWriteOverride(uint16_t addr, uint8_t val, g
     // Interrupt controller never overrides write requests
     return false;
 }
+
+gbtest::BusMapping gbtest::InterruptController::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // Interrupt Flag and Interrupt Enable registers
+    const BusMappingType interruptFlagMappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFF0F,
+            0xFF0F);
+    const BusMappingType interruptEnableMappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFFFF,
+            0xFFFF);
+
+    if (interruptFlagMappingType == BusMappingType::Full || interruptEnableMappingType == BusMappingType::Full) {
+        return BusMapping(this);
+    }
+
+    if (interruptFlagMappingType == BusMappingType::Partial || interruptEnableMappingType == BusMappingType::Partial) {
+        return BusMapping(BusMappingType::Partial);
+    }
+
+    return BusMapping(BusMappingType::Unmapped);
+}
+
+void gbtest::InterruptController::saveState(StateWriter& writer) const
+{
+    writer.write(m_interruptMasterEnable);
+    writer.write(m_delayedInterruptEnableCountdown);
+    writer.write(m_interruptEnable);
+    writer.write(m_interruptFlag);
+}
+
+void gbtest::InterruptController::loadState(StateReader& reader)
+{
+    reader.read(m_interruptMasterEnable);
+    reader.read(m_delayedInterruptEnableCountdown);
+    reader.read(m_interruptEnable);
+    reader.read(m_interruptFlag);
+}
@@ -4,6 +4,8 @@
 #include "InterruptType.h"
 #include "../../platform/bus/BusProvider.h"
 #include "../../platform/bus/Bus.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 #include "../../utils/Tickable.h"
 
 namespace gbtest {
@@ -19,6 +21,7 @@ public:
     [[nodiscard]] bool isInterruptMasterEnabled() const;
 
     void setDelayedInterruptEnableCountdown(int delayedInterruptEnableCountdown);
+    [[nodiscard]] bool hasDelayedInterruptEnable() const;
     void handleDelayedInterrupt();
 
     void setInterruptEnabled(InterruptType interruptType, bool enabled);
@@ -29,6 +32,11 @@ public:
     [[nodiscard]] bool isInterruptRequested(InterruptType interruptType) const;
     [[nodiscard]] uint8_t getInterruptRequest() const;
 
+    [[nodiscard]] bool hasPendingInterrupt() const; // Requested and enabled, whatever the master enable
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     void tick() override;
 
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
@@ -37,6 +45,8 @@ public:
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     bool m_interruptMasterEnable;
     int m_delayedInterruptEnableCountdown;
@@ -45,7 +55,6 @@ private:
     uint8_t m_interruptFlag;
 
     Bus& m_bus;
-    uint8_t m_previousInterruptLines;
 
 }; // class InterruptController
 
@@ -0,0 +1,49 @@
+#include "ExecutableMemory.h"
+
+#include <sys/mman.h>
+
+gbtest::ExecutableMemory::ExecutableMemory()
+        : m_data(nullptr)
+        , m_size(0)
+{
+
+}
+
+gbtest::ExecutableMemory::~ExecutableMemory()
+{
+    release();
+}
+
+bool gbtest::ExecutableMemory::allocate(size_t size)
+{
+    release();
+
+    // Systems enforcing W^X refuse the mapping, the caller then has to do without generated code
+    void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) { return false; }
+
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+
+    return true;
+}
+
+void gbtest::ExecutableMemory::release()
+{
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+uint8_t* gbtest::ExecutableMemory::getData() const
+{
+    return m_data;
+}
+
+size_t gbtest::ExecutableMemory::getSize() const
+{
+    return m_size;
+}
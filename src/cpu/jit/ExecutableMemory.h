@@ -0,0 +1,35 @@
+#ifndef GBTEST_EXECUTABLEMEMORY_H
+#define GBTEST_EXECUTABLEMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gbtest {
+
+/*
+ * Block of host memory that is writable and executable at the same time, for generated code
+ */
+class ExecutableMemory {
+
+public:
+    ExecutableMemory();
+    ~ExecutableMemory();
+
+    ExecutableMemory(const ExecutableMemory&) = delete;
+    ExecutableMemory& operator=(const ExecutableMemory&) = delete;
+
+    bool allocate(size_t size);
+    void release();
+
+    [[nodiscard]] uint8_t* getData() const;
+    [[nodiscard]] size_t getSize() const;
+
+private:
+    uint8_t* m_data;
+    size_t m_size;
+
+}; // class ExecutableMemory
+
+} // namespace gbtest
+
+#endif //GBTEST_EXECUTABLEMEMORY_H
@@ -0,0 +1,14 @@
+#ifndef GBTEST_JITBLOCKEXIT_H
+#define GBTEST_JITBLOCKEXIT_H
+
+namespace gbtest {
+
+enum class JitBlockExit {
+    NotCompiled,         // The instruction at PC must be interpreted
+    InstructionBoundary, // Every executed instruction is complete
+    CyclesPending,       // The last instruction reached the target cycle, its remaining cycles must still be wasted
+}; // enum class JitBlockExit
+
+} // namespace gbtest
+
+#endif //GBTEST_JITBLOCKEXIT_H
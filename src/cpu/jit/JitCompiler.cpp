@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+#include "JitCompiler.h"
+
+#include "../decoder/BlockDecoding.h"
+#include "../LR35902.h"
+
+namespace {
+
+// Minimal x86-64 code writer, the instructions are written as raw bytes at the call site
+class CodeWriter {
+
+public:
+    explicit CodeWriter(uint8_t* code)
+            : m_code(code)
+            , m_size(0)
+    {
+
+    }
+
+    void write(std::initializer_list<uint8_t> bytes)
+    {
+        for (const uint8_t byte: bytes) {
+            m_code[m_size++] = byte;
+        }
+    }
+
+    template<typename T>
+    void write(T value)
+    {
+        std::memcpy(m_code + m_size, &value, sizeof(T));
+        m_size += sizeof(T);
+    }
+
+    // Write a 32 bits jump displacement to be patched once the target is known
+    size_t writeJumpPlaceholder()
+    {
+        write<int32_t>(0);
+        return m_size - sizeof(int32_t);
+    }
+
+    void patchJump(size_t placeholderOffset)
+    {
+        const int32_t displacement = static_cast<int32_t>(m_size - (placeholderOffset + sizeof(int32_t)));
+        std::memcpy(m_code + placeholderOffset, &displacement, sizeof(displacement));
+    }
+
+    [[nodiscard]] size_t getSize() const
+    {
+        return m_size;
+    }
+
+private:
+    uint8_t* m_code;
+    size_t m_size;
+
+}; // class CodeWriter
+
+} // namespace
+
+gbtest::JitCompiler::JitCompiler(LR35902& cpu, Bus& bus)
+        : m_cpu(cpu)
+        , m_bus(bus)
+        , m_codeBufferUsedSize(0)
+        , m_blockCache(s_blockCacheSize)
+        , m_compiledBlockCount(0)
+{
+    const auto getOffset = [&](const void* member) -> int32_t {
+        return static_cast<int32_t>(static_cast<const uint8_t*>(member) - reinterpret_cast<const uint8_t*>(&cpu));
+    };
+
+    m_pcOffset = getOffset(&cpu.m_registers.pc);
+    m_cyclesToWaitOffset = getOffset(&cpu.m_cyclesToWait);
+    m_tickCounterOffset = getOffset(&cpu.m_tickCounter);
+
+    if (isSupported()) {
+        // Without the buffer, every block is left to the interpreter
+        m_codeBuffer.allocate(s_codeBufferSize);
+    }
+
+    flush();
+}
+
+bool gbtest::JitCompiler::isSupported()
+{
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+gbtest::JitBlockExit gbtest::JitCompiler::runBlock(uint64_t limitCycle, uint64_t targetCycle)
+{
+    const uint16_t pc = m_cpu.m_registers.pc;
+
+    // The I/O page and the code that isn't plain memory are always interpreted
+    const uint8_t* hostCode = (pc < 0xFF00) ? m_bus.getReadMemory(pc) : nullptr;
+
+    if (hostCode == nullptr || m_codeBuffer.getData() == nullptr) {
+        return JitBlockExit::NotCompiled;
+    }
+
+    // Find the block, compiling it again if its code changed since
+    const uintptr_t hostAddress = reinterpret_cast<uintptr_t>(hostCode);
+    Block& block = m_blockCache[(hostAddress ^ (hostAddress >> 11)) & (s_blockCacheSize - 1)];
+
+    if (block.hostCode != hostCode || block.pc != pc || std::memcmp(hostCode, block.guestCode.data(), block.size) != 0) {
+        compileBlock(block, pc, hostCode);
+    }
+
+    if (block.instructionCount == 0) {
+        return JitBlockExit::NotCompiled;
+    }
+
+    const uint32_t exitCode = block.code(&m_cpu, m_bus.getScheduler().getCurrentCycleData(), limitCycle, targetCycle);
+
+    return (exitCode == 0) ? JitBlockExit::InstructionBoundary : JitBlockExit::CyclesPending;
+}
+
+void gbtest::JitCompiler::flush()
+{
+    std::fill(m_blockCache.begin(), m_blockCache.end(), Block{nullptr, 0, 0, 0, nullptr, {}});
+    m_codeBufferUsedSize = 0;
+    m_compiledBlockCount = 0;
+}
+
+size_t gbtest::JitCompiler::getCompiledBlockCount() const
+{
+    return m_compiledBlockCount;
+}
+
+void gbtest::JitCompiler::compileBlock(Block& block, uint16_t pc, const uint8_t* hostCode)
+{
+    // Start over when the buffer is full, the blocks still in use are compiled again on their next run
+    if (m_codeBufferUsedSize + s_maxBlockCodeSize > m_codeBuffer.getSize()) {
+        flush();
+    }
+
+    // The block stays in the page of its first instruction, which the host code address was looked up from
+    const size_t pageEnd = 0x100 - (pc & 0xFF);
+    size_t size = 0;
+    size_t instructionCount = 0;
+
+    CodeWriter writer(m_codeBuffer.getData() + m_codeBufferUsedSize);
+
+    // Prologue: save the callee-saved registers (keeping the stack aligned for the calls) and keep the arguments there
+    writer.write({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57}); // push rbx, r12, r13, r14, r15
+    writer.write({0x48, 0x89, 0xFB});                                       // mov rbx, rdi (CPU)
+    writer.write({0x49, 0x89, 0xF4});                                       // mov r12, rsi (current cycle)
+    writer.write({0x49, 0x89, 0xD5});                                       // mov r13, rdx (limit cycle)
+    writer.write({0x49, 0x89, 0xCE});                                       // mov r14, rcx (target cycle)
+
+    std::vector<size_t> boundaryExits;
+    std::vector<size_t> pendingExits;
+
+    while (instructionCount < s_maxBlockInstructionCount) {
+        const uint8_t opcode = hostCode[size];
+        const size_t length = BlockDecoding::getInstructionLength(opcode);
+
+        if (length == 0 || size + length > pageEnd) { break; }
+
+        const uint8_t cbOpcode = (opcode == 0xCB) ? hostCode[size + 1] : 0x00;
+        const uint16_t nextPc = static_cast<uint16_t>(pc + size + 1);
+
+        // The instruction must be the last one if it ends the block, the others stop at the limit cycle
+        if (instructionCount > 0) {
+            writer.write({0x4C, 0x39, 0xEA});                               // cmp rdx, r13
+            writer.write({0x0F, 0x83});                                     // jae boundaryExit
+            boundaryExits.push_back(writer.writeJumpPlaceholder());
+        }
+
+        // Skip the opcode like the fetch would, and call its handler
+        writer.write({0x66, 0xC7, 0x83});                                   // mov word [rbx + pc], nextPc
+        writer.write<int32_t>(m_pcOffset);
+        writer.write<uint16_t>(nextPc);
+        writer.write({0x48, 0x89, 0xDF});                                   // mov rdi, rbx
+        writer.write({0x48, 0xB8});                                         // mov rax, handler
+        writer.write(reinterpret_cast<uintptr_t>(LR35902::s_opcodeHandlers[opcode]));
+        writer.write({0xFF, 0xD0});                                         // call rax
+
+        // Count the cycles of the instruction, unless it goes past the target cycle
+        writer.write({0x0F, 0xB6, 0x83});                                   // movzx eax, byte [rbx + cyclesToWait]
+        writer.write<int32_t>(m_cyclesToWaitOffset);
+        writer.write({0x49, 0x8B, 0x14, 0x24});                             // mov rdx, [r12]
+        writer.write({0x48, 0x01, 0xC2});                                   // add rdx, rax
+        writer.write({0x4C, 0x39, 0xF2});                                   // cmp rdx, r14
+        writer.write({0x0F, 0x87});                                         // ja pendingExit
+        pendingExits.push_back(writer.writeJumpPlaceholder());
+        writer.write({0x49, 0x89, 0x14, 0x24});                             // mov [r12], rdx
+        writer.write({0x01, 0x83});                                         // add dword [rbx + tickCounter], eax
+        writer.write<int32_t>(m_tickCounterOffset);
+        writer.write({0xC6, 0x83});                                         // mov byte [rbx + cyclesToWait], 0
+        writer.write<int32_t>(m_cyclesToWaitOffset);
+        writer.write<uint8_t>(0x00);
+
+        size += length;
+        ++instructionCount;
+
+        if (BlockDecoding::isBlockEnd(opcode, cbOpcode)) { break; }
+    }
+
+    // Exits: 0 at an instruction boundary, 1 with cycles left to waste
+    for (const size_t boundaryExit: boundaryExits) {
+        writer.patchJump(boundaryExit);
+    }
+
+    writer.write({0x31, 0xC0});                                             // xor eax, eax
+    writer.write({0xEB, 0x05});                                             // jmp epilogue
+
+    for (const size_t pendingExit: pendingExits) {
+        writer.patchJump(pendingExit);
+    }
+
+    writer.write({0xB8, 0x01, 0x00, 0x00, 0x00});                           // mov eax, 1
+    writer.write({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B});   // pop r15, r14, r13, r12, rbx
+    writer.write({0xC3});                                                   // ret
+
+    // Keep the guest code to check it on each run, at least the opcode of a block that couldn't be compiled
+    block.hostCode = hostCode;
+    block.pc = pc;
+    block.size = static_cast<uint8_t>(std::max<size_t>(size, 1));
+    block.instructionCount = static_cast<uint8_t>(instructionCount);
+    block.code = reinterpret_cast<CompiledCode>(m_codeBuffer.getData() + m_codeBufferUsedSize);
+    std::memcpy(block.guestCode.data(), hostCode, block.size);
+
+    if (instructionCount > 0) {
+        m_codeBufferUsedSize += writer.getSize();
+        ++m_compiledBlockCount;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef GBTEST_JITCOMPILER_H
+#define GBTEST_JITCOMPILER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ExecutableMemory.h"
+#include "JitBlockExit.h"
+
+#include "../../platform/bus/Bus.h"
+
+namespace gbtest {
+
+class LR35902;
+
+/*
+ * Translates the guest basic blocks into x86-64 code calling the opcode handlers back to back (call threading)
+ * Decoding, dispatching and the per-instruction checks of the interpreter loop are done once, when compiling
+ * The cycles are still counted after each instruction, so the scheduler is exact at every memory access,
+ * and the block is left at the first instruction boundary where the interpreter would have stopped
+ *
+ * Blocks follow the rules of BlockDecoding, the I/O page is left to the interpreter too
+ * Blocks are cached by host code address and PC, which tells the ROM banks apart, and checked against the guest
+ * code on each run, so that modified RAM code is compiled again
+ */
+class JitCompiler {
+
+public:
+    JitCompiler(LR35902& cpu, Bus& bus);
+
+    JitCompiler(const JitCompiler&) = delete;
+    JitCompiler& operator=(const JitCompiler&) = delete;
+
+    [[nodiscard]] static bool isSupported(); // x86-64 System V hosts only
+
+    // Run the block at PC, the instruction boundaries from the limit cycle on end it early
+    JitBlockExit runBlock(uint64_t limitCycle, uint64_t targetCycle);
+    void flush();
+
+    [[nodiscard]] size_t getCompiledBlockCount() const;
+
+private:
+    using CompiledCode = uint32_t (*)(LR35902* cpu, uint64_t* currentCycle, uint64_t limitCycle, uint64_t targetCycle);
+
+    static constexpr size_t s_blockCacheSize = 0x800;       // Must be a power of 2
+    static constexpr size_t s_maxBlockInstructionCount = 16;
+    static constexpr size_t s_maxBlockSize = s_maxBlockInstructionCount * 3;
+    static constexpr size_t s_codeBufferSize = 0x100000;
+    static constexpr size_t s_maxBlockCodeSize = 0x800;
+
+    struct Block {
+        const uint8_t* hostCode;    // nullptr if the cache entry is free
+        uint16_t pc;
+        uint8_t size;
+        uint8_t instructionCount;   // 0 if the first instruction can't be compiled
+        CompiledCode code;
+        std::array<uint8_t, s_maxBlockSize> guestCode;
+    }; // struct Block
+
+    LR35902& m_cpu;
+    Bus& m_bus;
+
+    ExecutableMemory m_codeBuffer;
+    size_t m_codeBufferUsedSize;
+
+    std::vector<Block> m_blockCache;
+    size_t m_compiledBlockCount;
+
+    // Offsets of the members the generated code accesses, relative to the CPU
+    int32_t m_pcOffset;
+    int32_t m_cyclesToWaitOffset;
+    int32_t m_tickCounterOffset;
+
+    void compileBlock(Block& block, uint16_t pc, const uint8_t* hostCode);
+
+}; // class JitCompiler
+
+} // namespace gbtest
+
+#endif //GBTEST_JITCOMPILER_H
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "CpuProfiler.h"
+
+gbtest::CpuProfiler::CpuProfiler()
+        : m_entries(0x10000)
+        , m_totalCycleCount(0)
+        , m_stackNodes{{0, s_rootStackNode, 0}}
+        , m_currentStackNode(s_rootStackNode)
+        , m_stackDepth(0)
+        , m_untrackedStackDepth(0)
+{
+
+}
+
+void gbtest::CpuProfiler::setRomBankGetter(RomBankGetter romBankGetter)
+{
+    m_romBankGetter = std::move(romBankGetter);
+}
+
+void gbtest::CpuProfiler::reset()
+{
+    std::fill(m_entries.begin(), m_entries.end(), Entry{0, 0});
+    m_bankedEntries.clear();
+    m_totalCycleCount = 0;
+
+    m_backwardJumps.clear();
+
+    m_stackNodes.resize(1);
+    m_stackNodes[s_rootStackNode].cycleCount = 0;
+    m_stackNodeIndices.clear();
+    m_currentStackNode = s_rootStackNode;
+    m_stackDepth = 0;
+    m_untrackedStackDepth = 0;
+}
+
+void gbtest::CpuProfiler::onInstruction(uint16_t pc, uint8_t cycleCount)
+{
+    Entry& entry = getKeyEntry(getKey(pc));
+
+    ++entry.instructionCount;
+    entry.cycleCount += cycleCount;
+    m_totalCycleCount += cycleCount;
+
+    m_stackNodes[m_currentStackNode].cycleCount += cycleCount;
+}
+
+void gbtest::CpuProfiler::onBackwardJump(uint16_t sourcePc, uint16_t targetPc)
+{
+    ++m_backwardJumps[(static_cast<uint64_t>(getKey(sourcePc)) << 32) | getKey(targetPc)];
+}
+
+void gbtest::CpuProfiler::onCall(uint16_t targetPc)
+{
+    // Past the maximum depth (recursion, or a stack the guest code unwinds by hand), only count the calls
+    if (m_stackDepth == s_maxStackDepth) {
+        ++m_untrackedStackDepth;
+        return;
+    }
+
+    const uint32_t key = getKey(targetPc);
+    const uint64_t nodeId = (static_cast<uint64_t>(m_currentStackNode) << 32) | key;
+    const auto nodeIt = m_stackNodeIndices.find(nodeId);
+
+    if (nodeIt != m_stackNodeIndices.end()) {
+        m_currentStackNode = nodeIt->second;
+    }
+    else {
+        m_stackNodes.push_back({key, m_currentStackNode, 0});
+        m_currentStackNode = static_cast<uint32_t>(m_stackNodes.size() - 1);
+        m_stackNodeIndices.emplace(nodeId, m_currentStackNode);
+    }
+
+    ++m_stackDepth;
+}
+
+void gbtest::CpuProfiler::onReturn()
+{
+    if (m_untrackedStackDepth > 0) {
+        --m_untrackedStackDepth;
+        return;
+    }
+
+    // Returning from the root happens when the guest code pushed the return address itself
+    if (m_currentStackNode != s_rootStackNode) {
+        m_currentStackNode = m_stackNodes[m_currentStackNode].parent;
+        --m_stackDepth;
+    }
+}
+
+uint64_t gbtest::CpuProfiler::getTotalCycleCount() const
+{
+    return m_totalCycleCount;
+}
+
+const gbtest::CpuProfiler::Entry& gbtest::CpuProfiler::getEntry(uint16_t pc, unsigned romBank) const
+{
+    static constexpr Entry s_emptyEntry{0, 0};
+
+    const uint32_t key = (pc >= 0x4000 && pc < 0x8000) ? ((romBank << 16) | pc) : pc;
+    const Entry* entry = findKeyEntry(key);
+
+    return (entry != nullptr) ? *entry : s_emptyEntry;
+}
+
+void gbtest::CpuProfiler::writeHotSpotReport(std::ostream& stream, size_t maxLineCount) const
+{
+    char line[96];
+    const double totalCycleCount = std::max<double>(m_totalCycleCount, 1);
+
+    // Hot spots: every executed address, the most cycles first
+    std::vector<std::pair<uint32_t, Entry>> hotSpots;
+
+    for (uint32_t pc = 0; pc < m_entries.size(); ++pc) {
+        if (m_entries[pc].instructionCount > 0) {
+            hotSpots.emplace_back(pc, m_entries[pc]);
+        }
+    }
+
+    for (uint32_t bank = 0; bank < m_bankedEntries.size(); ++bank) {
+        for (uint32_t offset = 0; offset < m_bankedEntries[bank].size(); ++offset) {
+            if (m_bankedEntries[bank][offset].instructionCount > 0) {
+                hotSpots.emplace_back((bank << 16) | (0x4000 + offset), m_bankedEntries[bank][offset]);
+            }
+        }
+    }
+
+    std::sort(hotSpots.begin(), hotSpots.end(), [](const auto& lhs, const auto& rhs) -> bool {
+        return lhs.second.cycleCount > rhs.second.cycleCount;
+    });
+
+    snprintf(line, sizeof(line), "Total: %llu cycles\n\nHot spots\n%7s %16s %14s  %s\n",
+            static_cast<unsigned long long>(m_totalCycleCount), "%", "cycles", "instructions", "address");
+    stream << line;
+
+    for (size_t i = 0; i < std::min(maxLineCount, hotSpots.size()); ++i) {
+        const Entry& entry = hotSpots[i].second;
+
+        snprintf(line, sizeof(line), "%6.2f%% %16llu %14llu  ", 100.0 * entry.cycleCount / totalCycleCount,
+                static_cast<unsigned long long>(entry.cycleCount),
+                static_cast<unsigned long long>(entry.instructionCount));
+        stream << line;
+        writeKey(stream, hotSpots[i].first);
+        stream << '\n';
+    }
+
+    // Hot loops: every backward jump, with the cycles spent between its target and itself
+    struct Loop {
+        uint32_t sourceKey;
+        uint32_t targetKey;
+        uint64_t iterationCount;
+        uint64_t cycleCount;
+    }; // struct Loop
+
+    std::vector<Loop> loops;
+
+    for (const auto& backwardJump: m_backwardJumps) {
+        Loop loop{static_cast<uint32_t>(backwardJump.first >> 32), static_cast<uint32_t>(backwardJump.first),
+                backwardJump.second, 0};
+
+        // A jump to another bank isn't a loop anyone can read
+        if ((loop.sourceKey >> 16) == (loop.targetKey >> 16)) {
+            for (uint32_t key = loop.targetKey; key <= loop.sourceKey; ++key) {
+                const Entry* entry = findKeyEntry(key);
+                loop.cycleCount += (entry != nullptr) ? entry->cycleCount : 0;
+            }
+        }
+
+        loops.push_back(loop);
+    }
+
+    std::sort(loops.begin(), loops.end(), [](const Loop& lhs, const Loop& rhs) -> bool {
+        return lhs.cycleCount > rhs.cycleCount;
+    });
+
+    snprintf(line, sizeof(line), "\nHot loops\n%7s %16s %14s  %s\n", "%", "cycles", "iterations", "range");
+    stream << line;
+
+    for (size_t i = 0; i < std::min(maxLineCount, loops.size()); ++i) {
+        snprintf(line, sizeof(line), "%6.2f%% %16llu %14llu  ", 100.0 * loops[i].cycleCount / totalCycleCount,
+                static_cast<unsigned long long>(loops[i].cycleCount),
+                static_cast<unsigned long long>(loops[i].iterationCount));
+        stream << line;
+        writeKey(stream, loops[i].targetKey);
+        stream << '-';
+        writeKey(stream, loops[i].sourceKey);
+        stream << '\n';
+    }
+}
+
+void gbtest::CpuProfiler::writeFoldedStacks(std::ostream& stream) const
+{
+    std::vector<uint32_t> frames;
+
+    for (uint32_t nodeIndex = 0; nodeIndex < m_stackNodes.size(); ++nodeIndex) {
+        if (m_stackNodes[nodeIndex].cycleCount == 0) { continue; }
+
+        // Walk up to the root, the frames are written outermost first
+        frames.clear();
+
+        for (uint32_t frameIndex = nodeIndex; frameIndex != s_rootStackNode; frameIndex = m_stackNodes[frameIndex].parent) {
+            frames.push_back(m_stackNodes[frameIndex].key);
+        }
+
+        stream << "root";
+
+        for (auto frameIt = frames.rbegin(); frameIt != frames.rend(); ++frameIt) {
+            stream << ';';
+            writeKey(stream, *frameIt);
+        }
+
+        stream << ' ' << m_stackNodes[nodeIndex].cycleCount << '\n';
+    }
+}
+
+uint32_t gbtest::CpuProfiler::getKey(uint16_t pc) const
+{
+    // Only the switchable ROM bank needs the bank number, without a cartridge it is bank 1
+    if (pc < 0x4000 || pc >= 0x8000) {
+        return pc;
+    }
+
+    const unsigned romBank = m_romBankGetter ? m_romBankGetter() : 1;
+
+    return (romBank << 16) | pc;
+}
+
+gbtest::CpuProfiler::Entry& gbtest::CpuProfiler::getKeyEntry(uint32_t key)
+{
+    const uint32_t bank = key >> 16;
+
+    if (bank == 0) {
+        return m_entries[key];
+    }
+
+    if (bank >= m_bankedEntries.size()) {
+        m_bankedEntries.resize(bank + 1);
+    }
+
+    std::vector<Entry>& bankEntries = m_bankedEntries[bank];
+
+    if (bankEntries.empty()) {
+        bankEntries.resize(0x4000, Entry{0, 0});
+    }
+
+    return bankEntries[(key & 0xFFFF) - 0x4000];
+}
+
+const gbtest::CpuProfiler::Entry* gbtest::CpuProfiler::findKeyEntry(uint32_t key) const
+{
+    const uint32_t bank = key >> 16;
+
+    if (bank == 0) {
+        return &m_entries[key];
+    }
+
+    if (bank >= m_bankedEntries.size() || m_bankedEntries[bank].empty()) {
+        return nullptr;
+    }
+
+    return &m_bankedEntries[bank][(key & 0xFFFF) - 0x4000];
+}
+
+void gbtest::CpuProfiler::writeKey(std::ostream& stream, uint32_t key)
+{
+    // Bank and address, like a debugger symbol file
+    char keyText[16];
+    snprintf(keyText, sizeof(keyText), "%02X:%04X", key >> 16, key & 0xFFFF);
+
+    stream << keyText;
+}
@@ -0,0 +1,79 @@
+#ifndef GBTEST_CPUPROFILER_H
+#define GBTEST_CPUPROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace gbtest {
+
+/*
+ * Guest code profiler: executed instructions and cycles per PC, loop iterations and inferred call stacks
+ * Addresses in the switchable ROM bank (4000h to 7FFFh) are keyed by bank, everything else by address only
+ * The CPU only feeds it when the core is built with GBTEST_CPU_PROFILER
+ */
+class CpuProfiler {
+
+public:
+    struct Entry {
+        uint64_t instructionCount;
+        uint64_t cycleCount;
+    }; // struct Entry
+
+    using RomBankGetter = std::function<unsigned()>;
+
+public:
+    CpuProfiler();
+
+    void setRomBankGetter(RomBankGetter romBankGetter);
+    void reset();
+
+    void onInstruction(uint16_t pc, uint8_t cycleCount);
+    void onBackwardJump(uint16_t sourcePc, uint16_t targetPc);
+    void onCall(uint16_t targetPc); // CALL, RST and interrupt entry
+    void onReturn();                // RET and RETI
+
+    [[nodiscard]] uint64_t getTotalCycleCount() const;
+    [[nodiscard]] const Entry& getEntry(uint16_t pc, unsigned romBank = 1) const;
+
+    void writeHotSpotReport(std::ostream& stream, size_t maxLineCount = 40) const;
+    void writeFoldedStacks(std::ostream& stream) const; // One "frame;frame;frame cycles" line per stack (flamegraph.pl)
+
+private:
+    static constexpr uint32_t s_rootStackNode = 0;
+    static constexpr unsigned s_maxStackDepth = 256;
+
+    struct StackNode {
+        uint32_t key;
+        uint32_t parent;
+        uint64_t cycleCount; // Spent in this function itself
+    }; // struct StackNode
+
+    RomBankGetter m_romBankGetter;
+
+    std::vector<Entry> m_entries;                     // Every address, indexed by PC
+    std::vector<std::vector<Entry>> m_bankedEntries;  // 4000h to 7FFFh, indexed by bank, allocated when first used
+    uint64_t m_totalCycleCount;
+
+    std::unordered_map<uint64_t, uint64_t> m_backwardJumps; // Source and target keys to iterations
+
+    std::vector<StackNode> m_stackNodes;
+    std::unordered_map<uint64_t, uint32_t> m_stackNodeIndices; // Parent index and key to child index
+    uint32_t m_currentStackNode;
+    unsigned m_stackDepth;
+    unsigned m_untrackedStackDepth; // Calls deeper than the maximum depth, attributed to the deepest function
+
+    [[nodiscard]] uint32_t getKey(uint16_t pc) const;
+    [[nodiscard]] Entry& getKeyEntry(uint32_t key);
+    [[nodiscard]] const Entry* findKeyEntry(uint32_t key) const;
+
+    static void writeKey(std::ostream& stream, uint32_t key);
+
+}; // class CpuProfiler
+
+} // namespace gbtest
+
+#endif //GBTEST_CPUPROFILER_H
@@ -0,0 +1,83 @@
+#include "Disassembler.h"
+
+#include "../decoder/CBOperation.h"
+
+// Register operands, in the order of the 3 bits selecting them
+static constexpr const char* s_registerNames[8] = {"B", "C", "D", "E", "H", "L", "(HL)", "A"};
+
+// Operations of the 80h to BFh block, and of the 0xCB-prefixed opcodes in the order of CBOperation
+static constexpr const char* s_aluOperationNames[8] = {"ADD A,", "ADC A,", "SUB", "SBC A,", "AND", "XOR", "OR", "CP"};
+static constexpr const char* s_cbOperationNames[11] = {
+        "RLC", "RRC", "RL", "RR", "SLA", "SRA", "SWAP", "SRL", "BIT", "RES", "SET"
+};
+
+// The opcodes around the register to register loads and the ALU operations on registers (40h to BFh)
+static constexpr const char* s_lowMnemonics[0x40] = {
+        "NOP", "LD BC, d16", "LD (BC), A", "INC BC", "INC B", "DEC B", "LD B, d8", "RLCA",
+        "LD (a16), SP", "ADD HL, BC", "LD A, (BC)", "DEC BC", "INC C", "DEC C", "LD C, d8", "RRCA",
+        "STOP", "LD DE, d16", "LD (DE), A", "INC DE", "INC D", "DEC D", "LD D, d8", "RLA",
+        "JR r8", "ADD HL, DE", "LD A, (DE)", "DEC DE", "INC E", "DEC E", "LD E, d8", "RRA",
+        "JR NZ, r8", "LD HL, d16", "LD (HL+), A", "INC HL", "INC H", "DEC H", "LD H, d8", "DAA",
+        "JR Z, r8", "ADD HL, HL", "LD A, (HL+)", "DEC HL", "INC L", "DEC L", "LD L, d8", "CPL",
+        "JR NC, r8", "LD SP, d16", "LD (HL-), A", "INC SP", "INC (HL)", "DEC (HL)", "LD (HL), d8", "SCF",
+        "JR C, r8", "ADD HL, SP", "LD A, (HL-)", "DEC SP", "INC A", "DEC A", "LD A, d8", "CCF",
+};
+
+static constexpr const char* s_highMnemonics[0x40] = {
+        "RET NZ", "POP BC", "JP NZ, a16", "JP a16", "CALL NZ, a16", "PUSH BC", "ADD A, d8", "RST 00h",
+        "RET Z", "RET", "JP Z, a16", "PREFIX CB", "CALL Z, a16", "CALL a16", "ADC A, d8", "RST 08h",
+        "RET NC", "POP DE", "JP NC, a16", "ILLEGAL", "CALL NC, a16", "PUSH DE", "SUB d8", "RST 10h",
+        "RET C", "RETI", "JP C, a16", "ILLEGAL", "CALL C, a16", "ILLEGAL", "SBC A, d8", "RST 18h",
+        "LDH (a8), A", "POP HL", "LD (C), A", "ILLEGAL", "ILLEGAL", "PUSH HL", "AND d8", "RST 20h",
+        "ADD SP, r8", "JP (HL)", "LD (a16), A", "ILLEGAL", "ILLEGAL", "ILLEGAL", "XOR d8", "RST 28h",
+        "LDH A, (a8)", "POP AF", "LD A, (C)", "DI", "ILLEGAL", "PUSH AF", "OR d8", "RST 30h",
+        "LD HL, SP+r8", "LD SP, HL", "LD A, (a16)", "EI", "ILLEGAL", "ILLEGAL", "CP d8", "RST 38h",
+};
+
+std::string gbtest::Disassembler::getMnemonic(uint16_t opcode)
+{
+    const char* operandName = s_registerNames[opcode & 0x7];
+
+    if (opcode >= 0x100) {
+        const uint8_t cbOpcode = opcode & 0xFF;
+        const CBOperation operation = getCBOperation(cbOpcode);
+        const std::string operationName = s_cbOperationNames[static_cast<size_t>(operation)];
+
+        if (operation == CBOperation::BIT || operation == CBOperation::RES || operation == CBOperation::SET) {
+            return operationName + " " + std::to_string(getCBBitIndex(cbOpcode)) + ", " + operandName;
+        }
+
+        return operationName + " " + operandName;
+    }
+
+    if (opcode < 0x40) {
+        return s_lowMnemonics[opcode];
+    }
+
+    if (opcode == 0x76) {
+        return "HALT";
+    }
+
+    if (opcode < 0x80) {
+        return std::string("LD ") + s_registerNames[(opcode >> 3) & 0x7] + ", " + operandName;
+    }
+
+    if (opcode < 0xC0) {
+        return std::string(s_aluOperationNames[(opcode >> 3) & 0x7]) + " " + operandName;
+    }
+
+    return s_highMnemonics[opcode - 0xC0];
+}
+
+size_t gbtest::Disassembler::getInstructionLength(uint16_t opcode)
+{
+    if (opcode >= 0x100 || opcode == 0x10) { return 2; } // STOP skips the byte following it
+
+    // The immediate operands tell the length
+    const std::string mnemonic = getMnemonic(opcode);
+
+    if (mnemonic.find("16") != std::string::npos) { return 3; }
+    if (mnemonic.find('8') != std::string::npos && mnemonic.find("RST") == std::string::npos) { return 2; }
+
+    return 1;
+}
@@ -0,0 +1,20 @@
+#ifndef GBTEST_DISASSEMBLER_H
+#define GBTEST_DISASSEMBLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Mnemonics of the instruction set, for the trace dumps
+ * 0xCB-prefixed opcodes are given as 100h to 1FFh, like in the trace entries
+ * The immediate operands are left as d8, d16, a8, a16 (addresses) and r8 (signed offsets), the traces don't keep them
+ */
+namespace gbtest::Disassembler {
+
+[[nodiscard]] std::string getMnemonic(uint16_t opcode);
+[[nodiscard]] size_t getInstructionLength(uint16_t opcode); // Prefix included
+
+} // namespace gbtest::Disassembler
+
+#endif //GBTEST_DISASSEMBLER_H
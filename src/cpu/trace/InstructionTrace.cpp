@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include "InstructionTrace.h"
+
+static_assert(sizeof(gbtest::InstructionTrace::Entry) == 16, "Trace entries are dumped as is");
+static_assert(sizeof(gbtest::InstructionTrace::DumpHeader) == 24, "The dump header is written as is");
+
+gbtest::InstructionTrace::InstructionTrace(size_t capacity)
+        : m_indexMask(0)
+        , m_recordCount(0)
+        , m_lastCycle(0)
+        , m_dumpRequested(false)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+
+    m_entries.resize(roundedCapacity);
+    m_indexMask = roundedCapacity - 1;
+}
+
+void gbtest::InstructionTrace::clear()
+{
+    m_recordCount = 0;
+    m_lastCycle = 0;
+}
+
+size_t gbtest::InstructionTrace::getCapacity() const
+{
+    return m_entries.size();
+}
+
+size_t gbtest::InstructionTrace::getEntryCount() const
+{
+    return static_cast<size_t>(std::min<uint64_t>(m_recordCount, m_entries.size()));
+}
+
+const gbtest::InstructionTrace::Entry& gbtest::InstructionTrace::getEntry(size_t index) const
+{
+    const uint64_t oldestIndex = m_recordCount - getEntryCount();
+
+    return m_entries[(oldestIndex + index) & m_indexMask];
+}
+
+void gbtest::InstructionTrace::setDumpPath(std::string dumpPath)
+{
+    m_dumpPath = std::move(dumpPath);
+}
+
+void gbtest::InstructionTrace::requestDump()
+{
+    m_dumpRequested.store(true, std::memory_order_relaxed);
+}
+
+void gbtest::InstructionTrace::writeRequestedDump()
+{
+    if (m_dumpRequested.exchange(false, std::memory_order_relaxed)) {
+        writeDumpFile(TraceDumpReason::Requested, nullptr);
+    }
+}
+
+bool gbtest::InstructionTrace::writeDump(std::ostream& stream, TraceDumpReason reason, const BusFault* fault) const
+{
+    DumpHeader header{};
+    header.magic = s_dumpMagic;
+    header.version = s_dumpVersion;
+    header.lastCycle = m_lastCycle;
+    header.entryCount = static_cast<uint32_t>(getEntryCount());
+    header.reason = reason;
+
+    if (fault != nullptr) {
+        header.faultType = static_cast<uint8_t>(fault->type);
+        header.faultAddr = fault->addr;
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // The ring holds the oldest entries after the newest ones once it wrapped
+    const size_t oldestIndex = (m_recordCount - header.entryCount) & m_indexMask;
+    const size_t firstPartSize = std::min<size_t>(header.entryCount, m_entries.size() - oldestIndex);
+
+    stream.write(reinterpret_cast<const char*>(&m_entries[oldestIndex]), firstPartSize * sizeof(Entry));
+    stream.write(reinterpret_cast<const char*>(m_entries.data()), (header.entryCount - firstPartSize) * sizeof(Entry));
+
+    return !stream.fail();
+}
+
+bool gbtest::InstructionTrace::writeDumpFile(TraceDumpReason reason, const BusFault* fault) const
+{
+    if (m_dumpPath.empty()) { return false; }
+
+    std::ofstream dumpFile(m_dumpPath, std::ios::binary);
+
+    return writeDump(dumpFile, reason, fault);
+}
+
+void gbtest::InstructionTrace::onFault(const BusFault& fault)
+{
+    // The instruction at fault was recorded before running, it is the newest entry
+    writeDumpFile(TraceDumpReason::Fault, &fault);
+}
+
+bool gbtest::InstructionTrace::readDump(std::istream& stream, DumpHeader& header, std::vector<Entry>& entries)
+{
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (stream.fail() || header.magic != s_dumpMagic || header.version != s_dumpVersion) { return false; }
+
+    entries.resize(header.entryCount);
+    stream.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(Entry));
+
+    return !stream.fail();
+}
+
+std::vector<uint64_t> gbtest::InstructionTrace::getEntryCycles(const DumpHeader& header,
+        const std::vector<Entry>& entries)
+{
+    // Only the newest stamp is whole, going back assumes less than 2^23 cycles (2 seconds) between two instructions
+    std::vector<uint64_t> cycles(entries.size());
+    if (entries.empty()) { return cycles; }
+
+    cycles.back() = header.lastCycle;
+
+    for (size_t i = entries.size() - 1; i > 0; --i) {
+        const uint32_t elapsedCycles = ((entries[i].stamp >> s_opcodeBits) - (entries[i - 1].stamp >> s_opcodeBits))
+                & s_cycleMask;
+
+        cycles[i - 1] = cycles[i] - elapsedCycles;
+    }
+
+    return cycles;
+}
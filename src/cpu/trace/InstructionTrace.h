@@ -0,0 +1,124 @@
+#ifndef GBTEST_INSTRUCTIONTRACE_H
+#define GBTEST_INSTRUCTIONTRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../LR35902Registers.h"
+#include "../../platform/bus/BusFault.h"
+#include "../../platform/bus/BusFaultListener.h"
+
+namespace gbtest {
+
+enum class TraceDumpReason : uint8_t {
+    Requested,  // Asked for by the user
+    Fault,      // First bus fault (unmapped read or write, illegal opcode)
+}; // enum class TraceDumpReason
+
+/*
+ * Ring buffer of the last instructions executed by the CPU, with the registers as they were before each of them
+ * Only the emulation thread touches the ring, other threads ask for a dump through a flag, so nothing ever locks
+ * Dumps are binary (see DumpHeader, in host byte order), gbtest-tracedump prints them as disassembly
+ * The CPU only feeds it when the core is built with GBTEST_CPU_TRACE
+ */
+class InstructionTrace
+        : public BusFaultListener {
+
+public:
+    static constexpr size_t s_defaultCapacity = 0x10000;
+    static constexpr unsigned s_opcodeBits = 9; // 0xCB-prefixed opcodes are stored as 100h to 1FFh
+    static constexpr uint32_t s_opcodeMask = (1u << s_opcodeBits) - 1;
+    static constexpr uint32_t s_cycleMask = (1u << (32 - s_opcodeBits)) - 1;
+
+    struct Entry {
+        uint32_t stamp; // Opcode in the low bits, low bits of the cycle the instruction started on above
+        uint16_t af;
+        uint16_t bc;
+        uint16_t de;
+        uint16_t hl;
+        uint16_t sp;
+        uint16_t pc;
+    }; // struct Entry
+
+    struct DumpHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t lastCycle;     // Whole cycle stamp of the newest entry
+        uint32_t entryCount;    // Entries following the header, from the oldest to the newest
+        TraceDumpReason reason;
+        uint8_t faultType;      // BusFaultType, only meaningful for the dumps on faults
+        uint16_t faultAddr;
+    }; // struct DumpHeader
+
+    explicit InstructionTrace(size_t capacity = s_defaultCapacity); // Rounded up to a power of 2
+    ~InstructionTrace() override = default;
+
+    // AF apart from the other registers, F isn't kept up to date with the lazy flags
+    void record(uint16_t pc, uint8_t opcode, uint16_t af, const LR35902Registers& registers, uint64_t cycle);
+    void recordCBOpcode(uint8_t cbOpcode); // Completes the newest entry, when it is a CBh prefix
+    void clear();
+
+    [[nodiscard]] size_t getCapacity() const;
+    [[nodiscard]] size_t getEntryCount() const;
+    [[nodiscard]] const Entry& getEntry(size_t index) const; // From the oldest (0) to the newest
+
+    void setDumpPath(std::string dumpPath); // Where the dumps on faults and requests go, empty to skip them
+    void requestDump(); // From any thread, written by the next call to writeRequestedDump()
+    void writeRequestedDump(); // From the emulation thread, between two batches
+    bool writeDump(std::ostream& stream, TraceDumpReason reason, const BusFault* fault = nullptr) const;
+
+    void onFault(const BusFault& fault) override;
+
+    // For the dump readers
+    static bool readDump(std::istream& stream, DumpHeader& header, std::vector<Entry>& entries);
+    [[nodiscard]] static std::vector<uint64_t> getEntryCycles(const DumpHeader& header, const std::vector<Entry>& entries);
+
+private:
+    static constexpr uint32_t s_dumpMagic = 0x52544247;   // "GBTR"
+    static constexpr uint32_t s_dumpVersion = 1;          // Increment when the dump layout changes
+
+    std::vector<Entry> m_entries;
+    size_t m_indexMask;
+    uint64_t m_recordCount;
+    uint64_t m_lastCycle;
+
+    std::string m_dumpPath;
+    std::atomic<bool> m_dumpRequested;
+
+    bool writeDumpFile(TraceDumpReason reason, const BusFault* fault) const; // To the dump path
+
+}; // class InstructionTrace
+
+} // namespace gbtest
+
+// Recording is defined here so that it can be inlined in the CPU loops
+inline void gbtest::InstructionTrace::record(uint16_t pc, uint8_t opcode, uint16_t af,
+        const LR35902Registers& registers, uint64_t cycle)
+{
+    Entry& entry = m_entries[m_recordCount & m_indexMask];
+
+    entry.stamp = (static_cast<uint32_t>(cycle) << s_opcodeBits) | opcode;
+    entry.af = af;
+    entry.bc = registers.bc;
+    entry.de = registers.de;
+    entry.hl = registers.hl;
+    entry.sp = registers.sp;
+    entry.pc = pc;
+
+    ++m_recordCount;
+    m_lastCycle = cycle;
+}
+
+inline void gbtest::InstructionTrace::recordCBOpcode(uint8_t cbOpcode)
+{
+    uint32_t& stamp = m_entries[(m_recordCount - 1) & m_indexMask].stamp;
+
+    stamp = (stamp & ~s_opcodeMask) | 0x100 | cbOpcode;
+}
+
+#endif //GBTEST_INSTRUCTIONTRACE_H
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../platform/GameBoy.h"
+
+static constexpr uint64_t s_clockFrequency = 4194304;  // Cycles per second
+static constexpr uint64_t s_cyclesPerFrame = 70224;    // 154 lines of 456 cycles
+
+static void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " <rom> [options]" << std::endl
+              << "  --frames <n>        Run for n frames worth of cycles (default: 600)" << std::endl
+              << "  --cycles <n>        Run for n cycles" << std::endl
+              << "  --dump-frames <dir> Write the completed frames to <dir> as PPM images" << std::endl
+              << "  --dump-every <n>    Only write every n-th frame (default: 1)" << std::endl
+              << "  --scanline          Use the scanline renderer instead of the FIFO" << std::endl
+              << "  --on-fault <policy> open-bus (default), trap (stop the run) or abort" << std::endl
+              << "  --no-block-cache    Fetch and dispatch every instruction instead of running decoded blocks" << std::endl;
+#ifdef GBTEST_CPU_JIT
+    std::cerr << "  --jit               Run the guest code through the JIT when possible" << std::endl;
+#endif
+#ifdef GBTEST_CPU_PROFILER
+    std::cerr << "  --profile <prefix>  Write hot spots to <prefix>.txt and folded stacks to <prefix>.folded" << std::endl;
+#endif
+#ifdef GBTEST_CPU_TRACE
+    std::cerr << "  --trace <file>      Dump the last instructions to <file> on the first fault, or at the end" << std::endl;
+#endif
+}
+
+static bool parseErrorPolicy(const char* policyName, gbtest::BusErrorPolicy& errorPolicy)
+{
+    if (std::strcmp(policyName, "open-bus") == 0) {
+        errorPolicy = gbtest::BusErrorPolicy::OpenBus;
+    }
+    else if (std::strcmp(policyName, "trap") == 0) {
+        errorPolicy = gbtest::BusErrorPolicy::Trap;
+    }
+    else if (std::strcmp(policyName, "abort") == 0) {
+        errorPolicy = gbtest::BusErrorPolicy::Abort;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+static bool writePpm(const std::string& path, const gbtest::Framebuffer::FramebufferContainer& framebuffer)
+{
+    FILE* ppmFile = fopen(path.c_str(), "wb");
+    if (ppmFile == nullptr) { return false; }
+
+    // Binary PPM: RGB triplets, the alpha component is dropped
+    fprintf(ppmFile, "P6\n160 144\n255\n");
+
+    for (const uint32_t pixel: framebuffer) {
+        const uint8_t rgb[3] = {
+                static_cast<uint8_t>(pixel),
+                static_cast<uint8_t>(pixel >> 8),
+                static_cast<uint8_t>(pixel >> 16)
+        };
+        fwrite(rgb, sizeof(rgb), 1, ppmFile);
+    }
+
+    fclose(ppmFile);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* romPath = nullptr;
+    uint64_t cycleCount = 600 * s_cyclesPerFrame;
+    std::string dumpDirectory;
+    uint64_t dumpInterval = 1;
+    bool scanlineRendering = false;
+    gbtest::BusErrorPolicy errorPolicy = gbtest::BusErrorPolicy::OpenBus;
+    bool blockCacheEnabled = true;
+#ifdef GBTEST_CPU_JIT
+    bool jitEnabled = false;
+#endif
+    std::string profilePrefix;
+    std::string tracePath;
+
+    // Parse the command line
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = (i + 1 < argc);
+
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            cycleCount = std::strtoull(argv[++i], nullptr, 10) * s_cyclesPerFrame;
+        }
+        else if (std::strcmp(argv[i], "--cycles") == 0 && hasValue) {
+            cycleCount = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--dump-frames") == 0 && hasValue) {
+            dumpDirectory = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--dump-every") == 0 && hasValue) {
+            dumpInterval = std::max<uint64_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--scanline") == 0) {
+            scanlineRendering = true;
+        }
+        else if (std::strcmp(argv[i], "--on-fault") == 0 && hasValue && parseErrorPolicy(argv[i + 1], errorPolicy)) {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--no-block-cache") == 0) {
+            blockCacheEnabled = false;
+        }
+#ifdef GBTEST_CPU_JIT
+        else if (std::strcmp(argv[i], "--jit") == 0) {
+            jitEnabled = true;
+        }
+#endif
+#ifdef GBTEST_CPU_PROFILER
+        else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) {
+            profilePrefix = argv[++i];
+        }
+#endif
+#ifdef GBTEST_CPU_TRACE
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            tracePath = argv[++i];
+        }
+#endif
+        else if (argv[i][0] != '-' && romPath == nullptr) {
+            romPath = argv[i];
+        }
+        else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (romPath == nullptr) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    gbtest::GameBoy gameboy;
+    gameboy.init();
+    gameboy.getPpu().getModeManager().setScanlineRenderingEnabled(scanlineRendering);
+    gameboy.getBus().setErrorPolicy(errorPolicy);
+    gameboy.getCpu().setBlockCacheEnabled(blockCacheEnabled);
+#ifdef GBTEST_CPU_JIT
+    gameboy.getCpu().setJitEnabled(jitEnabled);
+#endif
+
+    const gbtest::CartridgeLoadStatus loadStatus = gameboy.loadCartridge(romPath);
+    if (loadStatus != gbtest::CartridgeLoadStatus::Success) {
+        std::cerr << "Couldn't load ROM file " << romPath << ": "
+                  << gbtest::Cartridge::getLoadStatusDescription(loadStatus) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Count (and dump) the frames on the emulation thread, as they complete
+    uint64_t frameCount = 0;
+    bool dumpFailed = false;
+
+    gameboy.getPpu().getFramebuffer().setFramebufferReadyCallback(
+            [&](const gbtest::Framebuffer::FramebufferContainer& framebuffer) -> void {
+                if (!dumpDirectory.empty() && (frameCount % dumpInterval) == 0) {
+                    char fileName[32];
+                    snprintf(fileName, sizeof(fileName), "/frame_%06llu.ppm",
+                            static_cast<unsigned long long>(frameCount));
+
+                    dumpFailed |= !writePpm(dumpDirectory + fileName, framebuffer);
+                }
+
+                ++frameCount;
+            });
+
+#ifdef GBTEST_CPU_PROFILER
+    gbtest::CpuProfiler profiler;
+
+    if (!profilePrefix.empty()) {
+        gameboy.setCpuProfiler(&profiler);
+    }
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+    gbtest::InstructionTrace trace;
+    trace.setDumpPath(tracePath);
+
+    if (!tracePath.empty()) {
+        gameboy.setCpuTrace(&trace);
+    }
+#endif
+
+    // Run as fast as possible
+    const auto startTime = std::chrono::steady_clock::now();
+    cycleCount = gameboy.runCycles(cycleCount);
+    const auto endTime = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    printf("cycles: %llu\n", static_cast<unsigned long long>(cycleCount));
+    printf("frames: %llu\n", static_cast<unsigned long long>(frameCount));
+    printf("time: %.3f s\n", seconds);
+    printf("cycles/s: %.0f\n", static_cast<double>(cycleCount) / seconds);
+    printf("frames/s: %.1f\n", static_cast<double>(frameCount) / seconds);
+    printf("speed: %.1fx\n", static_cast<double>(cycleCount) / seconds / s_clockFrequency);
+
+    if (gameboy.getBus().hasFault()) {
+        static constexpr const char* s_faultDescriptions[] = {"Unmapped read", "Unmapped write", "Illegal opcode"};
+        const gbtest::BusFault& fault = gameboy.getBus().getFault();
+
+        printf("fault: %s at 0x%04X\n", s_faultDescriptions[static_cast<size_t>(fault.type)], fault.addr);
+
+        // Only a trap is an error, faults are expected to happen with the open bus policy
+        if (errorPolicy == gbtest::BusErrorPolicy::Trap) { return EXIT_FAILURE; }
+    }
+
+#ifdef GBTEST_CPU_PROFILER
+    if (!profilePrefix.empty()) {
+        std::ofstream reportFile(profilePrefix + ".txt");
+        profiler.writeHotSpotReport(reportFile);
+
+        std::ofstream foldedStacksFile(profilePrefix + ".folded");
+        profiler.writeFoldedStacks(foldedStacksFile);
+
+        if (!reportFile || !foldedStacksFile) {
+            std::cerr << "Couldn't write the profile to " << profilePrefix << ".txt and .folded" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+    // A fault dumped the trace already
+    if (!tracePath.empty() && !gameboy.getBus().hasFault()) {
+        std::ofstream traceFile(tracePath, std::ios::binary);
+
+        if (!trace.writeDump(traceFile, gbtest::TraceDumpReason::Requested)) {
+            std::cerr << "Couldn't write the trace to " << tracePath << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    if (dumpFailed) {
+        std::cerr << "Couldn't write some frames to " << dumpDirectory << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
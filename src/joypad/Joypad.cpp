@@ -0,0 +1,120 @@
+#include "Joypad.h"
+
+gbtest::Joypad::Joypad(Bus& bus)
+        : m_bus(bus)
+        , m_pressedButtons(0x00)
+        , m_selectBits(0x30)
+{
+
+}
+
+void gbtest::Joypad::setButtonPressed(JoypadButton button, bool pressed)
+{
+    if (pressed) {
+        setPressedButtons(m_pressedButtons | static_cast<uint8_t>(button));
+    }
+    else {
+        setPressedButtons(m_pressedButtons & ~static_cast<uint8_t>(button));
+    }
+}
+
+bool gbtest::Joypad::isButtonPressed(JoypadButton button) const
+{
+    return (m_pressedButtons & static_cast<uint8_t>(button)) != 0;
+}
+
+void gbtest::Joypad::setPressedButtons(uint8_t pressedButtons)
+{
+    m_pressedButtons = pressedButtons;
+    updateInterruptLine();
+}
+
+uint8_t gbtest::Joypad::getPressedButtons() const
+{
+    return m_pressedButtons;
+}
+
+void gbtest::Joypad::saveState(StateWriter& writer) const
+{
+    writer.write(m_pressedButtons);
+    writer.write(m_selectBits);
+}
+
+void gbtest::Joypad::loadState(StateReader& reader)
+{
+    // The interrupt line is restored with the bus
+    reader.read(m_pressedButtons);
+    reader.read(m_selectBits);
+}
+
+bool gbtest::Joypad::busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    // Joypad only uses address FF00h
+    if (addr != 0xFF00) {
+        return false;
+    }
+
+    // Unused bits read as 1, and so do the buttons that aren't pressed
+    val = 0xC0 | m_selectBits | (~getSelectedPressedButtons() & 0x0F);
+
+    return true;
+}
+
+bool gbtest::Joypad::busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    // Joypad only uses address FF00h
+    if (addr != 0xFF00) {
+        return false;
+    }
+
+    // Only the select bits are writable
+    m_selectBits = val & 0x30;
+    updateInterruptLine();
+
+    return true;
+}
+
+bool gbtest::Joypad::busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    // Joypad never overrides read requests
+    return false;
+}
+
+bool gbtest::Joypad::busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    // Joypad never overrides write requests
+    return false;
+}
+
+gbtest::BusMapping gbtest::Joypad::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFF00, 0xFF00);
+
+    // The register value depends on the buttons, it can't be backed by memory
+    if (mappingType == BusMappingType::Full) {
+        return BusMapping(this);
+    }
+
+    return BusMapping(mappingType);
+}
+
+uint8_t gbtest::Joypad::getSelectedPressedButtons() const
+{
+    uint8_t selectedPressedButtons = 0x00;
+
+    if ((m_selectBits & 0x10) == 0) {
+        selectedPressedButtons |= (m_pressedButtons & 0x0F);
+    }
+
+    if ((m_selectBits & 0x20) == 0) {
+        selectedPressedButtons |= (m_pressedButtons >> 4);
+    }
+
+    return selectedPressedButtons;
+}
+
+void gbtest::Joypad::updateInterruptLine()
+{
+    // The interrupt is requested when an input line goes low, that is when a selected button gets pressed
+    m_bus.setInterruptLineHigh(InterruptType::Joypad, getSelectedPressedButtons() != 0);
+}
@@ -0,0 +1,53 @@
+#ifndef GBTEST_JOYPAD_H
+#define GBTEST_JOYPAD_H
+
+#include <cstdint>
+
+#include "JoypadButton.h"
+
+#include "../platform/bus/Bus.h"
+#include "../platform/bus/BusProvider.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
+
+namespace gbtest {
+
+// [P1] Joypad register (FF00h), the game selects the direction keys or the action buttons and reads them back
+class Joypad
+        : public BusProvider {
+
+public:
+    explicit Joypad(Bus& bus);
+    ~Joypad() override = default;
+
+    void setButtonPressed(JoypadButton button, bool pressed);
+    [[nodiscard]] bool isButtonPressed(JoypadButton button) const;
+
+    void setPressedButtons(uint8_t pressedButtons); // Mask of JoypadButton values
+    [[nodiscard]] uint8_t getPressedButtons() const;
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+    bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
+private:
+    Bus& m_bus;
+
+    uint8_t m_pressedButtons;
+    uint8_t m_selectBits; // Bits 4 (direction keys) and 5 (action buttons) of P1, a group is selected when its bit is 0
+
+    [[nodiscard]] uint8_t getSelectedPressedButtons() const;
+    void updateInterruptLine();
+
+}; // class Joypad
+
+} // namespace gbtest
+
+#endif //GBTEST_JOYPAD_H
@@ -0,0 +1,20 @@
+#ifndef GBTEST_JOYPADBUTTON_H
+#define GBTEST_JOYPADBUTTON_H
+
+namespace gbtest {
+
+// Bits of the pressed buttons mask, the direction keys in the lower nibble and the action buttons in the upper one
+enum class JoypadButton {
+    Right = 1 << 0,
+    Left = 1 << 1,
+    Up = 1 << 2,
+    Down = 1 << 3,
+    A = 1 << 4,
+    B = 1 << 5,
+    Select = 1 << 6,
+    Start = 1 << 7,
+}; // enum class JoypadButton
+
+} // namespace gbtest
+
+#endif //GBTEST_JOYPADBUTTON_H
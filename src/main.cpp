@@ -1,12 +1,17 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <thread>
+#include <utility>
 
 #include <raylib.h>
 
 #include "platform/GameBoy.h"
+#include "platform/state/RewindBuffer.h"
 
-int main()
+int main(int argc, char** argv)
 {
     InitWindow(680, 616, "gbtest");
     SetTargetFPS(60);
@@ -14,8 +19,17 @@ int main()
     gbtest::GameBoy gameboy;
     gameboy.init();
 
+#ifdef GBTEST_CPU_TRACE
+    // Dumped on the first bus fault, and when T is pressed
+    gbtest::InstructionTrace trace;
+    trace.setDumpPath("trace.bin");
+    gameboy.setCpuTrace(&trace);
+#endif
+
+    gbtest::Framebuffer& framebuffer = gameboy.getPpu().getFramebuffer();
+
     Image lcdImage = {
-            &(gameboy.getPpu().getFramebuffer().getRawBuffer().front()),
+            const_cast<uint32_t*>(&(framebuffer.getPresentedBuffer().front())),
             160,
             144,
             1,
@@ -23,25 +37,20 @@ int main()
     };
     Texture2D lcdTex = LoadTextureFromImage(lcdImage);
 
-    gameboy.getPpu().getFramebuffer().setFramebufferReadyCallback(
-            [&](const gbtest::Framebuffer::FramebufferContainer& framebuffer) -> void {
-                // Copy the framebuffer for rendering
-                UpdateTexture(lcdTex, &(framebuffer.front()));
-            });
+    std::atomic<bool> running = true;
+    std::atomic<bool> tickEnabled = true;
+    std::atomic<unsigned> pendingSingleTicks = 0;
+    std::atomic<bool> rewinding = false;
+    std::atomic<uint8_t> pressedButtons = 0;
 
-    bool tickEnabled = true;
+    // Try to load a ROM file (given on the command line, boot.bin otherwise)
+    const char* romPath = (argc > 1) ? argv[1] : "boot.bin";
 
-    // Try to open a ROM file
-    if (FILE* gbRom = fopen("boot.bin", "rb"); gbRom != nullptr) {
-        uint8_t currByte;
-        unsigned offset = 0;
-        while (fread(&currByte, sizeof(currByte), 0x1, gbRom) > 0) {
-            gameboy.getBus().write(offset++, currByte, gbtest::BusRequestSource::Privileged);
-        }
+    if (const gbtest::CartridgeLoadStatus loadStatus = gameboy.loadCartridge(romPath);
+            loadStatus != gbtest::CartridgeLoadStatus::Success) {
+        std::cerr << "Couldn't load ROM file " << romPath << ": "
+                  << gbtest::Cartridge::getLoadStatusDescription(loadStatus) << std::endl;
 
-        fclose(gbRom);
-    }
-    else {
         gameboy.getBus().write(0x100, 0x3E, gbtest::BusRequestSource::Privileged); // LD A, 0xFF
         gameboy.getBus().write(0x101, 0xFF, gbtest::BusRequestSource::Privileged);
 
@@ -52,25 +61,86 @@ int main()
         gameboy.getBus().write(0x111, -2, gbtest::BusRequestSource::Privileged);
     }
 
+    // Emulate on a separate thread, the frames are handed over through the triple-buffered framebuffer
+    std::thread emulationThread([&]() -> void {
+        auto nextUpdateTime = std::chrono::steady_clock::now();
+
+        // Keep the last 10 seconds of updates, with a keyframe every second
+        gbtest::RewindBuffer rewindBuffer(600, 60);
+
+        while (running) {
+            gameboy.getJoypad().setPressedButtons(pressedButtons);
+
+            if (rewinding) {
+                // Go back one update, and run it again to show its frame
+                if (rewindBuffer.rewind(gameboy)) {
+                    gameboy.update(16667);
+                }
+            }
+            else if (tickEnabled) {
+                // Tick the CPU (if enabled)
+                // TODO: De-hardcode that
+                gameboy.update(16667);
+                rewindBuffer.push(gameboy);
+            }
+
+            for (unsigned singleTicks = pendingSingleTicks.exchange(0); singleTicks > 0; --singleTicks) {
+                gameboy.tick();
+            }
+
+            // Keep the pace of one update per 60 Hz frame, without trying to catch up if we're late
+            nextUpdateTime = std::max(nextUpdateTime + std::chrono::microseconds(16667),
+                    std::chrono::steady_clock::now());
+            std::this_thread::sleep_until(nextUpdateTime);
+        }
+    });
+
     while (!WindowShouldClose()) {
-        // Tick the CPU (if enabled)
-        if (tickEnabled) {
-            // TODO: De-hardcode that
-            gameboy.update(16667);
+        // Upload the newest complete frame (if any)
+        if (framebuffer.swapPresentedBuffer()) {
+            UpdateTexture(lcdTex, &(framebuffer.getPresentedBuffer().front()));
         }
 
+        // Map the keyboard to the joypad
+        static constexpr std::pair<int, gbtest::JoypadButton> s_keyMapping[] = {
+                {KEY_RIGHT,       gbtest::JoypadButton::Right},
+                {KEY_LEFT,        gbtest::JoypadButton::Left},
+                {KEY_UP,          gbtest::JoypadButton::Up},
+                {KEY_DOWN,        gbtest::JoypadButton::Down},
+                {KEY_X,           gbtest::JoypadButton::A},
+                {KEY_Z,           gbtest::JoypadButton::B},
+                {KEY_RIGHT_SHIFT, gbtest::JoypadButton::Select},
+                {KEY_ENTER,       gbtest::JoypadButton::Start},
+        };
+
+        uint8_t pressedKeys = 0;
+        for (const auto& [key, button]: s_keyMapping) {
+            if (IsKeyDown(key)) { pressedKeys |= static_cast<uint8_t>(button); }
+        }
+
+        pressedButtons = pressedKeys;
+
+        // Rewind while Backspace is held
+        rewinding = IsKeyDown(KEY_BACKSPACE);
+
         // Check if keys were pressed
         int keyPressed = 0;
         while ((keyPressed = GetKeyPressed()) != 0) {
             switch (keyPressed) {
             case KEY_SPACE:
-                gameboy.tick();
+                ++pendingSingleTicks;
                 break;
 
             case KEY_P:
                 tickEnabled = !tickEnabled;
                 break;
 
+#ifdef GBTEST_CPU_TRACE
+            case KEY_T:
+                trace.requestDump();
+                break;
+#endif
+
             default:
                 break;
             }
@@ -86,6 +156,9 @@ int main()
         EndDrawing();
     }
 
+    running = false;
+    emulationThread.join();
+
     CloseWindow();
 
     return 0;
@@ -13,6 +13,11 @@ gbtest::Memory::~Memory()
     delete[] m_memory;
 }
 
+uint32_t gbtest::Memory::getSize() const
+{
+    return m_memorySize;
+}
+
 bool gbtest::Memory::busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
 {
     const uint16_t offset = addr - m_baseAddress;
@@ -53,4 +58,28 @@ bool gbtest::Memory::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusReq
 {
     // Memory never overrides write requests
     return false;
-}
\ No newline at end of file
+}
+
+gbtest::BusMapping gbtest::Memory::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, m_baseAddress,
+            m_baseAddress + m_memorySize - 1);
+
+    // Memory is plain memory, it can be accessed directly
+    if (mappingType == BusMappingType::Full) {
+        uint8_t* const memory = m_memory + (firstAddr - m_baseAddress);
+        return BusMapping(this, memory, memory);
+    }
+
+    return BusMapping(mappingType);
+}
+
+void gbtest::Memory::saveState(StateWriter& writer) const
+{
+    writer.writeBytes(m_memory, m_memorySize);
+}
+
+void gbtest::Memory::loadState(StateReader& reader)
+{
+    reader.readBytes(m_memory, m_memorySize);
+}
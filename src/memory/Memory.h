@@ -2,6 +2,8 @@
 #define GBTEST_MEMORY_H
 
 #include "../platform/bus/BusProvider.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -12,12 +14,19 @@ public:
     Memory(uint16_t baseAddr, uint32_t size);
     ~Memory() override;
 
+    [[nodiscard]] uint32_t getSize() const;
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     uint16_t m_baseAddress;
     uint32_t m_memorySize;
@@ -2,10 +2,26 @@
 
 #define CLOCK_FREQ_MHZ 4.194304
 
+namespace {
+
+constexpr uint32_t s_stateMagic = 0x54534247; // "GBST"
+constexpr uint32_t s_stateVersion = 5;        // Increment when the saved members change
+
+struct StateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t payloadSize;
+}; // struct StateHeader
+
+} // namespace
+
 gbtest::GameBoy::GameBoy()
         : m_cpu(m_bus)
         , m_wholeMemory(0x0000, 0x10000)
         , m_ppu(m_bus)
+        , m_cartridge(m_bus)
+        , m_joypad(m_bus)
+        , m_timer(m_bus)
 {
 
 }
@@ -22,6 +38,9 @@ void gbtest::GameBoy::init()
 
     // Register bus providers
     registerBusProviders();
+
+    // Let the devices schedule their first event
+    synchronizeDevices(m_bus.getScheduler().getCurrentCycle());
 }
 
 void gbtest::GameBoy::update(int64_t delta)
@@ -29,15 +48,87 @@ void gbtest::GameBoy::update(int64_t delta)
     const int ticksToEmulate = delta * CLOCK_FREQ_MHZ;
 //    std::cout << "Emulating " << ticksToEmulate << " ticks" << std::endl;
 
-    for (unsigned i = 0; i < ticksToEmulate; ++i) {
-        tick();
+    runCycles(ticksToEmulate);
+}
+
+uint64_t gbtest::GameBoy::runCycles(uint64_t cycleCount)
+{
+    Scheduler& scheduler = m_bus.getScheduler();
+    const uint64_t startCycle = scheduler.getCurrentCycle();
+    const uint64_t targetCycle = startCycle + cycleCount;
+
+    while (scheduler.getCurrentCycle() < targetCycle) {
+        const uint64_t currentCycle = scheduler.getCurrentCycle();
+
+        // The devices only have to catch up if they have something to show the CPU before this cycle
+        if (scheduler.getNextEventCycle() < currentCycle) {
+            synchronizeDevices(currentCycle);
+        }
+
+        // Let the CPU run until then
+        m_cpu.runFor(targetCycle - currentCycle);
+
+        // Stop early if a fault must be looked at (checked once per batch, not on every request)
+        if (m_bus.shouldTrap()) { break; }
+    }
+
+    // Leave the devices in the state they would be in at the end of the emulated time
+    synchronizeDevices(scheduler.getCurrentCycle());
+
+#ifdef GBTEST_CPU_TRACE
+    // The dumps asked for by other threads are written here, the trace isn't being recorded in the meantime
+    if (InstructionTrace* trace = m_cpu.getTrace(); trace != nullptr) {
+        trace->writeRequestedDump();
     }
+#endif
+
+    return scheduler.getCurrentCycle() - startCycle;
 }
 
 void gbtest::GameBoy::tick()
 {
-    m_cpu.tick();
-    m_ppu.tick();
+    runCycles(1);
+}
+
+gbtest::CartridgeLoadStatus gbtest::GameBoy::loadCartridge(const std::string& romPath)
+{
+    // The new ROM may be mapped where the previous one was, its blocks must not be mistaken for the old ones
+    m_cpu.flushBlockCache();
+
+    return m_cartridge.load(romPath);
+}
+
+void gbtest::GameBoy::saveState(std::vector<uint8_t>& state) const
+{
+    StateWriter writer(state);
+
+    writer.write(StateHeader{s_stateMagic, s_stateVersion, getStatePayloadSize()});
+    saveStatePayload(writer);
+}
+
+gbtest::StateLoadStatus gbtest::GameBoy::loadState(const std::vector<uint8_t>& state)
+{
+    StateReader reader(state.data(), state.size());
+
+    StateHeader header;
+    reader.read(header);
+
+    if (reader.hasFailed() || header.magic != s_stateMagic) {
+        return StateLoadStatus::InvalidHeader;
+    }
+
+    if (header.version != s_stateVersion) {
+        return StateLoadStatus::UnsupportedVersion;
+    }
+
+    // Check the size before touching the devices, they would be left half loaded otherwise
+    if (header.payloadSize != reader.getRemainingSize() || header.payloadSize != getStatePayloadSize()) {
+        return StateLoadStatus::SizeMismatch;
+    }
+
+    loadStatePayload(reader);
+
+    return StateLoadStatus::Success;
 }
 
 gbtest::Bus& gbtest::GameBoy::getBus()
@@ -70,6 +161,52 @@ const gbtest::PPU& gbtest::GameBoy::getPpu() const
     return m_ppu;
 }
 
+gbtest::Cartridge& gbtest::GameBoy::getCartridge()
+{
+    return m_cartridge;
+}
+
+const gbtest::Cartridge& gbtest::GameBoy::getCartridge() const
+{
+    return m_cartridge;
+}
+
+gbtest::Joypad& gbtest::GameBoy::getJoypad()
+{
+    return m_joypad;
+}
+
+const gbtest::Joypad& gbtest::GameBoy::getJoypad() const
+{
+    return m_joypad;
+}
+
+#ifdef GBTEST_CPU_PROFILER
+void gbtest::GameBoy::setCpuProfiler(CpuProfiler* profiler)
+{
+    if (profiler != nullptr) {
+        profiler->setRomBankGetter([this]() -> unsigned {
+            return m_cartridge.getRomBankNumber();
+        });
+    }
+
+    m_cpu.setProfiler(profiler);
+}
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+void gbtest::GameBoy::setCpuTrace(InstructionTrace* trace)
+{
+    m_bus.setFaultListener(trace);
+    m_cpu.setTrace(trace);
+}
+#endif
+
+size_t gbtest::GameBoy::getMemoryFootprint() const
+{
+    return sizeof(GameBoy) + m_cpu.getOwnedMemorySize() + m_wholeMemory.getSize() + m_cartridge.getOwnedMemorySize();
+}
+
 void gbtest::GameBoy::resetCpuRegisters()
 {
     // DMG registers
@@ -100,6 +237,46 @@ void gbtest::GameBoy::resetCpuRegisters()
     ppuRegisters.dmgPalettes.bgPaletteData.raw = 0xFC;
     ppuRegisters.dmgPalettes.objectPaletteData0.raw = 0xFF;
     ppuRegisters.dmgPalettes.objectPaletteData1.raw = 0xFF;
+
+    // The LCD was turned on behind the PPU's back
+    m_ppu.getModeManager().updateBusLocks();
+}
+
+void gbtest::GameBoy::synchronizeDevices(uint64_t cycle)
+{
+    m_ppu.synchronize(cycle);
+    m_timer.synchronize(cycle);
+}
+
+uint64_t gbtest::GameBoy::getStatePayloadSize() const
+{
+    // Only count the bytes, the payload size depends on the cartridge RAM size
+    StateWriter sizeCounter;
+    saveStatePayload(sizeCounter);
+
+    return sizeCounter.getWrittenSize();
+}
+
+void gbtest::GameBoy::saveStatePayload(StateWriter& writer) const
+{
+    m_bus.saveState(writer);
+    m_cpu.saveState(writer);
+    m_wholeMemory.saveState(writer);
+    m_ppu.saveState(writer);
+    m_cartridge.saveState(writer);
+    m_joypad.saveState(writer);
+    m_timer.saveState(writer);
+}
+
+void gbtest::GameBoy::loadStatePayload(StateReader& reader)
+{
+    m_bus.loadState(reader);
+    m_cpu.loadState(reader);
+    m_wholeMemory.loadState(reader);
+    m_ppu.loadState(reader);
+    m_cartridge.loadState(reader);
+    m_joypad.loadState(reader);
+    m_timer.loadState(reader);
 }
 
 void gbtest::GameBoy::registerBusProviders()
@@ -107,12 +284,18 @@ void gbtest::GameBoy::registerBusProviders()
     // TODO: Have the real memory layout
     m_bus.registerBusProvider(&(m_cpu.getInterruptController()));
     m_bus.registerBusProvider(&m_ppu);
+    m_bus.registerBusProvider(&m_joypad);
+    m_bus.registerBusProvider(&m_timer);
+    m_bus.registerBusProvider(&m_cartridge); // Shadows the whole memory once a ROM is loaded
     m_bus.registerBusProvider(&m_wholeMemory);
 }
 
 void gbtest::GameBoy::unregisterBusProviders()
 {
     m_bus.unregisterBusProvider(&m_wholeMemory);
+    m_bus.unregisterBusProvider(&m_cartridge);
+    m_bus.unregisterBusProvider(&m_timer);
+    m_bus.unregisterBusProvider(&m_joypad);
     m_bus.unregisterBusProvider(&m_ppu);
     m_bus.unregisterBusProvider(&(m_cpu.getInterruptController()));
 }
@@ -1,11 +1,21 @@
 #ifndef GBTEST_GAMEBOY_H
 #define GBTEST_GAMEBOY_H
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "bus/Bus.h"
+#include "state/StateLoadStatus.h"
+#include "state/StateReader.h"
+#include "state/StateWriter.h"
 
+#include "../cartridge/Cartridge.h"
 #include "../cpu/LR35902.h"
+#include "../joypad/Joypad.h"
 #include "../memory/Memory.h"
 #include "../ppu/PPU.h"
+#include "../timer/Timer.h"
 #include "../utils/Tickable.h"
 
 namespace gbtest {
@@ -19,8 +29,18 @@ public:
 
     void init();
     void update(int64_t delta);
+    uint64_t runCycles(uint64_t cycleCount); // Returns the cycles run, less than asked if the bus trapped
     void tick() override;
 
+    [[nodiscard]] CartridgeLoadStatus loadCartridge(const std::string& romPath);
+
+    /*
+     * Snapshot of the whole machine, the cartridge ROM excepted (load the same one before loading a state)
+     * Saving into the same buffer again doesn't allocate, loading never does
+     */
+    void saveState(std::vector<uint8_t>& state) const;
+    [[nodiscard]] StateLoadStatus loadState(const std::vector<uint8_t>& state);
+
     [[nodiscard]] Bus& getBus();
     [[nodiscard]] const Bus& getBus() const;
 
@@ -30,13 +50,37 @@ public:
     [[nodiscard]] PPU& getPpu();
     [[nodiscard]] const PPU& getPpu() const;
 
+    [[nodiscard]] Cartridge& getCartridge();
+    [[nodiscard]] const Cartridge& getCartridge() const;
+
+    [[nodiscard]] Joypad& getJoypad();
+    [[nodiscard]] const Joypad& getJoypad() const;
+
+#ifdef GBTEST_CPU_PROFILER
+    void setCpuProfiler(CpuProfiler* profiler); // Also lets it know the ROM bank, nullptr to stop profiling
+#endif
+
+#ifdef GBTEST_CPU_TRACE
+    void setCpuTrace(InstructionTrace* trace); // Also dumps it on the first bus fault, nullptr to stop tracing
+#endif
+
+    [[nodiscard]] size_t getMemoryFootprint() const; // Bytes owned by this instance, the mapped ROM excepted
+
 private:
     Bus m_bus;
     LR35902 m_cpu;
     Memory m_wholeMemory;
     PPU m_ppu;
+    Cartridge m_cartridge;
+    Joypad m_joypad;
+    Timer m_timer;
 
     void resetCpuRegisters();
+    void synchronizeDevices(uint64_t cycle);
+
+    [[nodiscard]] uint64_t getStatePayloadSize() const;
+    void saveStatePayload(StateWriter& writer) const;
+    void loadStatePayload(StateReader& reader);
 
     void registerBusProviders();
     void unregisterBusProviders();
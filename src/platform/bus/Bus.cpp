@@ -1,17 +1,29 @@
 #include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
 
 #include "Bus.h"
 
-#include "../../exceptions/bus/BusLockedAddressException.h"
-#include "../../exceptions/bus/BusNoHandlerException.h"
-
 gbtest::Bus::Bus()
-        : m_interruptLines(0)
+        : m_pageTable()
+        , m_highPageTable()
+        , m_mappedEntries()
+        , m_overrideCounts()
+        , m_writeWatchedPages()
+        , m_writeWatcher(nullptr)
+        , m_interruptLines(0)
+        , m_raisedInterruptLines(0)
+        , m_errorPolicy(BusErrorPolicy::OpenBus)
+        , m_faulted(false)
+        , m_fault{BusFaultType::UnmappedRead, 0, BusRequestSource::Unknown}
+        , m_faultListener(nullptr)
 {
 
 }
 
-uint8_t gbtest::Bus::read(uint16_t addr, BusRequestSource requestSource) const
+uint8_t gbtest::Bus::readFromProviders(uint16_t addr, BusRequestSource requestSource) const
 {
     // Variable declaration
     size_t i = 0;
@@ -28,15 +40,16 @@ uint8_t gbtest::Bus::read(uint16_t addr, BusRequestSource requestSource) const
         ++i;
     }
 
-    // Throw an exception if no provider was found
+    // Nothing drives the bus if no provider was found
     if (i == m_busProviders.size()) {
-        throw BusNoHandlerException(addr, false);
+        reportFault(BusFaultType::UnmappedRead, addr, requestSource);
+        return 0xFF;
     }
 
     return val;
 }
 
-void gbtest::Bus::write(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+void gbtest::Bus::writeToProviders(uint16_t addr, uint8_t val, BusRequestSource requestSource)
 {
     // Check first if a provider overrides the request
     for (BusProvider* const busProvider: m_busProviders) {
@@ -48,25 +61,152 @@ void gbtest::Bus::write(uint16_t addr, uint8_t val, BusRequestSource requestSour
         if (busProvider->busWrite(addr, val, requestSource)) { return; }
     }
 
-    // Throw an exception if no provider was found
-    throw BusNoHandlerException(addr, true);
+    // The write is lost if no provider was found
+    reportFault(BusFaultType::UnmappedWrite, addr, requestSource);
 }
 
 void gbtest::Bus::registerBusProvider(BusProvider* busProvider)
 {
     // Push the provider to the provider list
     m_busProviders.push_back(busProvider);
+
+    // The new provider may shadow or override any address
+    remapAddressRange(0x0000, 0xFFFF);
 }
 
 void gbtest::Bus::unregisterBusProvider(BusProvider* busProvider)
 {
     // Remove the provider from the provider list
     m_busProviders.erase(std::remove(m_busProviders.begin(), m_busProviders.end(), busProvider), m_busProviders.end());
+
+    // Requests must not reach the removed provider anymore
+    remapAddressRange(0x0000, 0xFFFF);
+}
+
+void gbtest::Bus::remapAddressRange(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // Rebuild every page overlapping the range
+    for (unsigned page = (firstAddr >> 8); page <= std::min<unsigned>(lastAddr >> 8, 0xFE); ++page) {
+        m_mappedEntries[page] = buildMapEntry(page << 8, (page << 8) | 0xFF);
+        refreshMapEntry(page);
+    }
+
+    // The last page is decoded address by address
+    for (unsigned addr = std::max<unsigned>(firstAddr, 0xFF00); addr <= lastAddr; ++addr) {
+        m_mappedEntries[0x100 + (addr & 0xFF)] = buildMapEntry(addr, addr);
+        refreshMapEntry(0x100 + (addr & 0xFF));
+    }
+}
+
+void gbtest::Bus::remapAddressRangeMemory(const BusProvider* busProvider, uint16_t firstAddr, uint16_t lastAddr,
+        const uint8_t* readMemory, uint8_t* writeMemory)
+{
+    /*
+     * Cheaper remapAddressRange() for the bank switches: the pages the provider handles alone only get their memory
+     * pointers moved to the new bank (nullptr when the provider stops backing them with memory), without asking every
+     * provider again. The range must be made of whole pages, below the I/O page
+     */
+    assert((firstAddr & 0xFF) == 0x00 && (lastAddr & 0xFF) == 0xFF && lastAddr < 0xFF00);
+
+    for (unsigned page = (firstAddr >> 8); page <= (static_cast<unsigned>(lastAddr) >> 8); ++page) {
+        BusMapEntry& mappedEntry = m_mappedEntries[page];
+        const size_t offset = (page << 8) - firstAddr;
+
+        if (mappedEntry.provider == busProvider) {
+            mappedEntry.readMemory = (readMemory != nullptr) ? readMemory + offset : nullptr;
+            mappedEntry.writeMemory = (writeMemory != nullptr) ? writeMemory + offset : nullptr;
+        }
+        else {
+            // Shared or shadowed page, the providers decide
+            mappedEntry = buildMapEntry(page << 8, (page << 8) | 0xFF);
+        }
+
+        refreshMapEntry(page);
+    }
+}
+
+void gbtest::Bus::setAddressRangeOverridden(uint16_t firstAddr, uint16_t lastAddr, bool overridden)
+{
+    /*
+     * Providers call this when they start or stop overriding requests in a range, so that the page table sends them
+     * to the provider list again. Overrides are counted, every call setting one must be balanced by a call clearing it
+     */
+    auto updateOverrideCount = [&](unsigned entryIndex) {
+        m_overrideCounts[entryIndex] += overridden ? 1 : -1;
+        refreshMapEntry(entryIndex);
+    };
+
+    for (unsigned page = (firstAddr >> 8); page <= std::min<unsigned>(lastAddr >> 8, 0xFE); ++page) {
+        updateOverrideCount(page);
+    }
+
+    for (unsigned addr = std::max<unsigned>(firstAddr, 0xFF00); addr <= lastAddr; ++addr) {
+        updateOverrideCount(0x100 + (addr & 0xFF));
+    }
+}
+
+void gbtest::Bus::setWriteWatcher(BusWriteWatcher* writeWatcher)
+{
+    m_writeWatcher = writeWatcher;
+}
+
+void gbtest::Bus::setPageWriteWatched(uint8_t page, bool watched)
+{
+    // The high page is decoded address by address and can't be watched
+    assert(page < 0xFF && (!watched || m_writeWatcher != nullptr));
+
+    m_writeWatchedPages[page] = watched;
+    refreshMapEntry(page);
+}
+
+bool gbtest::Bus::isPageWritable(uint8_t page) const
+{
+    return page < 0xFF && m_mappedEntries[page].writeMemory != nullptr;
+}
+
+gbtest::Bus::BusMapEntry gbtest::Bus::buildMapEntry(uint16_t firstAddr, uint16_t lastAddr) const
+{
+    // Ask every provider how it handles the range, in dispatch order
+    BusMapping busMapping;
+
+    for (BusProvider* const busProvider: m_busProviders) {
+        busMapping.merge(busProvider->getBusMapping(firstAddr, lastAddr));
+    }
+
+    // Only a range fully handled by a single provider can skip the provider list
+    if (busMapping.type != BusMappingType::Full) {
+        return {nullptr, nullptr, nullptr};
+    }
+
+    return {busMapping.provider, busMapping.readMemory, busMapping.writeMemory};
+}
+
+gbtest::Bus::BusMapEntry& gbtest::Bus::getMapEntry(unsigned entryIndex)
+{
+    return (entryIndex < 0x100) ? m_pageTable[entryIndex] : m_highPageTable[entryIndex - 0x100];
+}
+
+void gbtest::Bus::refreshMapEntry(unsigned entryIndex)
+{
+    // Overridden entries must go through every provider
+    if (m_overrideCounts[entryIndex] > 0) {
+        getMapEntry(entryIndex) = {nullptr, nullptr, nullptr};
+    }
+    else {
+        getMapEntry(entryIndex) = m_mappedEntries[entryIndex];
+    }
+
+    // Writes to watched pages must take the slow path, where they are reported
+    if (entryIndex < 0x100 && m_writeWatchedPages[entryIndex]) {
+        getMapEntry(entryIndex).writeMemory = nullptr;
+    }
 }
 
 void gbtest::Bus::setInterruptLineHigh(gbtest::InterruptType interruptType, bool isHigh)
 {
     if (isHigh) {
+        // Remember the rising edge, the interrupt controller may only look at the lines a long time after
+        m_raisedInterruptLines |= static_cast<uint8_t>(interruptType) & ~m_interruptLines;
         m_interruptLines |= static_cast<uint8_t>(interruptType);
     }
     else {
@@ -83,3 +223,88 @@ uint8_t gbtest::Bus::getInterruptLines() const
 {
     return m_interruptLines;
 }
+
+uint8_t gbtest::Bus::takeRaisedInterruptLines()
+{
+    const uint8_t raisedInterruptLines = m_raisedInterruptLines;
+    m_raisedInterruptLines = 0;
+
+    return raisedInterruptLines;
+}
+
+gbtest::Scheduler& gbtest::Bus::getScheduler()
+{
+    return m_scheduler;
+}
+
+const gbtest::Scheduler& gbtest::Bus::getScheduler() const
+{
+    return m_scheduler;
+}
+
+void gbtest::Bus::setErrorPolicy(BusErrorPolicy errorPolicy)
+{
+    m_errorPolicy = errorPolicy;
+}
+
+gbtest::BusErrorPolicy gbtest::Bus::getErrorPolicy() const
+{
+    return m_errorPolicy;
+}
+
+void gbtest::Bus::reportFault(BusFaultType faultType, uint16_t addr, BusRequestSource requestSource) const
+{
+    // Keep the first fault, it is the one that matters when debugging
+    if (!m_faulted) {
+        m_faulted = true;
+        m_fault = {faultType, addr, requestSource};
+
+        if (m_faultListener != nullptr) {
+            m_faultListener->onFault(m_fault);
+        }
+    }
+
+    if (m_errorPolicy == BusErrorPolicy::Abort) {
+        static constexpr const char* s_faultDescriptions[] = {"Unmapped read", "Unmapped write", "Illegal opcode"};
+
+        std::cerr << s_faultDescriptions[static_cast<size_t>(faultType)] << " at 0x" << std::uppercase << std::hex
+                  << std::setw(4) << std::setfill('0') << addr << std::endl;
+        std::abort();
+    }
+}
+
+bool gbtest::Bus::hasFault() const
+{
+    return m_faulted;
+}
+
+const gbtest::BusFault& gbtest::Bus::getFault() const
+{
+    return m_fault;
+}
+
+void gbtest::Bus::clearFault()
+{
+    m_faulted = false;
+}
+
+void gbtest::Bus::setFaultListener(BusFaultListener* faultListener)
+{
+    m_faultListener = faultListener;
+}
+
+void gbtest::Bus::saveState(StateWriter& writer) const
+{
+    writer.write(m_interruptLines);
+    writer.write(m_raisedInterruptLines);
+
+    m_scheduler.saveState(writer);
+}
+
+void gbtest::Bus::loadState(StateReader& reader)
+{
+    reader.read(m_interruptLines);
+    reader.read(m_raisedInterruptLines);
+
+    m_scheduler.loadState(reader);
+}
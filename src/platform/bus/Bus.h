@@ -1,12 +1,19 @@
 #ifndef GBTEST_BUS_H
 #define GBTEST_BUS_H
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
+#include "BusFault.h"
+#include "BusFaultListener.h"
 #include "BusProvider.h"
 #include "BusRequestSource.h"
+#include "BusWriteWatcher.h"
 
+#include "../scheduler/Scheduler.h"
+#include "../state/StateReader.h"
+#include "../state/StateWriter.h"
 #include "../../cpu/interrupts/InterruptType.h"
 
 namespace gbtest {
@@ -18,20 +25,129 @@ public:
 
     [[nodiscard]] uint8_t read(uint16_t addr, BusRequestSource requestSource) const;
     void write(uint16_t addr, uint8_t val, BusRequestSource requestSource);
+    [[nodiscard]] const uint8_t* getReadMemory(uint16_t addr) const; // Host memory backing reads, nullptr if none
 
     void registerBusProvider(BusProvider* busProvider);
     void unregisterBusProvider(BusProvider* busProvider);
+    void remapAddressRange(uint16_t firstAddr, uint16_t lastAddr);
+    void remapAddressRangeMemory(const BusProvider* busProvider, uint16_t firstAddr, uint16_t lastAddr,
+            const uint8_t* readMemory, uint8_t* writeMemory); // Bank switches, see the definition
+    void setAddressRangeOverridden(uint16_t firstAddr, uint16_t lastAddr, bool overridden);
+
+    // Writes to the watched pages (from 0000h to FEFFh) are reported to the watcher before being done
+    void setWriteWatcher(BusWriteWatcher* writeWatcher); // nullptr once no page is watched anymore
+    void setPageWriteWatched(uint8_t page, bool watched);
+    [[nodiscard]] bool isPageWritable(uint8_t page) const; // Plain memory backs the writes to the page (overrides aside)
 
     void setInterruptLineHigh(InterruptType interruptType, bool isHigh);
     [[nodiscard]] bool isInterruptLineHigh(InterruptType interruptType) const;
     [[nodiscard]] uint8_t getInterruptLines() const;
+    [[nodiscard]] uint8_t takeRaisedInterruptLines();
+
+    [[nodiscard]] Scheduler& getScheduler();
+    [[nodiscard]] const Scheduler& getScheduler() const;
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+    void setErrorPolicy(BusErrorPolicy errorPolicy);
+    [[nodiscard]] BusErrorPolicy getErrorPolicy() const;
+
+    // Faults are recorded instead of interrupting the request, the emulation loop checks for them once per batch
+    void reportFault(BusFaultType faultType, uint16_t addr, BusRequestSource requestSource) const;
+    [[nodiscard]] bool hasFault() const;
+    [[nodiscard]] const BusFault& getFault() const; // First fault since the last call to clearFault()
+    void clearFault();
+    [[nodiscard]] bool shouldTrap() const;
+    void setFaultListener(BusFaultListener* faultListener); // nullptr to stop listening
 
 private:
+    // Entry of the address decoding tables (every member is null when the request must go through every provider)
+    struct BusMapEntry {
+        BusProvider* provider;      // Provider handling every address of the entry
+        const uint8_t* readMemory;  // Host memory backing reads of the entry
+        uint8_t* writeMemory;       // Host memory backing writes of the entry
+    }; // struct BusMapEntry
+
     std::vector<BusProvider*> m_busProviders;
+    std::array<BusMapEntry, 0x100> m_pageTable;     // One entry per 256 bytes page (from 0000h to FEFFh)
+    std::array<BusMapEntry, 0x100> m_highPageTable; // One entry per address in the I/O and HRAM page (from FF00h to FFFFh)
+    std::array<BusMapEntry, 0x200> m_mappedEntries; // Entries built from the providers, ignoring the overrides
+    std::array<uint8_t, 0x200> m_overrideCounts;    // Number of active overrides of each entry
+    std::array<bool, 0x100> m_writeWatchedPages;    // Pages whose writes take the slow path to be reported
+    BusWriteWatcher* m_writeWatcher;
     uint8_t m_interruptLines;
+    uint8_t m_raisedInterruptLines; // Lines that went high since the last call to takeRaisedInterruptLines()
+
+    Scheduler m_scheduler;
+
+    BusErrorPolicy m_errorPolicy;
+    mutable bool m_faulted;
+    mutable BusFault m_fault;
+    BusFaultListener* m_faultListener;
+
+    [[nodiscard]] uint8_t readFromProviders(uint16_t addr, BusRequestSource requestSource) const;
+    void writeToProviders(uint16_t addr, uint8_t val, BusRequestSource requestSource);
+
+    [[nodiscard]] BusMapEntry buildMapEntry(uint16_t firstAddr, uint16_t lastAddr) const;
+    [[nodiscard]] BusMapEntry& getMapEntry(unsigned entryIndex);
+    void refreshMapEntry(unsigned entryIndex);
 
 }; // class Bus
 
 } // namespace gbtest
 
+// The page table lookups are defined here so that they can be inlined in the CPU and DMA loops
+inline uint8_t gbtest::Bus::read(uint16_t addr, BusRequestSource requestSource) const
+{
+    // Find the entry handling this address
+    const BusMapEntry& mapEntry = (addr < 0xFF00) ? m_pageTable[addr >> 8] : m_highPageTable[addr & 0xFF];
+    const uint16_t offset = (addr < 0xFF00) ? (addr & 0xFF) : 0;
+
+    // Plain memory is read directly
+    if (mapEntry.readMemory != nullptr) { return mapEntry.readMemory[offset]; }
+
+    // Otherwise, the request goes straight to the provider if there is only one
+    if (mapEntry.provider != nullptr) {
+        uint8_t val = 0;
+        if (mapEntry.provider->busRead(addr, val, requestSource)) { return val; }
+    }
+
+    return readFromProviders(addr, requestSource);
+}
+
+inline void gbtest::Bus::write(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    // Find the entry handling this address
+    const BusMapEntry& mapEntry = (addr < 0xFF00) ? m_pageTable[addr >> 8] : m_highPageTable[addr & 0xFF];
+    const uint16_t offset = (addr < 0xFF00) ? (addr & 0xFF) : 0;
+
+    // Plain memory is written directly
+    if (mapEntry.writeMemory != nullptr) {
+        mapEntry.writeMemory[offset] = val;
+        return;
+    }
+
+    // Otherwise, let the watcher know first if the page is watched (its plain memory is never written directly)
+    if (addr < 0xFF00 && m_writeWatchedPages[addr >> 8]) { m_writeWatcher->onWatchedWrite(addr); }
+
+    // Then, the request goes straight to the provider if there is only one
+    if (mapEntry.provider != nullptr && mapEntry.provider->busWrite(addr, val, requestSource)) { return; }
+
+    writeToProviders(addr, val, requestSource);
+}
+
+inline const uint8_t* gbtest::Bus::getReadMemory(uint16_t addr) const
+{
+    const BusMapEntry& mapEntry = (addr < 0xFF00) ? m_pageTable[addr >> 8] : m_highPageTable[addr & 0xFF];
+    const uint16_t offset = (addr < 0xFF00) ? (addr & 0xFF) : 0;
+
+    return (mapEntry.readMemory != nullptr) ? mapEntry.readMemory + offset : nullptr;
+}
+
+inline bool gbtest::Bus::shouldTrap() const
+{
+    return m_faulted && m_errorPolicy == BusErrorPolicy::Trap;
+}
+
 #endif //GBTEST_BUS_H
@@ -0,0 +1,31 @@
+#ifndef GBTEST_BUSFAULT_H
+#define GBTEST_BUSFAULT_H
+
+#include <cstdint>
+
+#include "BusRequestSource.h"
+
+namespace gbtest {
+
+// What the bus does when a request can't be served
+enum class BusErrorPolicy {
+    OpenBus,    // Unmapped reads return FFh and unmapped writes are ignored, like on hardware
+    Trap,       // Same as OpenBus, but the emulation stops at the end of the current batch (e.g. for a debugger)
+    Abort,      // Print the fault and abort the program right away
+}; // enum class BusErrorPolicy
+
+enum class BusFaultType {
+    UnmappedRead,   // No provider handled a read
+    UnmappedWrite,  // No provider handled a write
+    IllegalOpcode,  // The CPU fetched an opcode that doesn't exist (it locks up)
+}; // enum class BusFaultType
+
+struct BusFault {
+    BusFaultType type;
+    uint16_t addr;
+    BusRequestSource requestSource;
+}; // struct BusFault
+
+} // namespace gbtest
+
+#endif //GBTEST_BUSFAULT_H
@@ -0,0 +1,19 @@
+#ifndef GBTEST_BUSFAULTLISTENER_H
+#define GBTEST_BUSFAULTLISTENER_H
+
+#include "BusFault.h"
+
+namespace gbtest {
+
+class BusFaultListener {
+
+public:
+    virtual ~BusFaultListener() = default;
+
+    virtual void onFault(const BusFault& fault) = 0; // Called for the first fault, before aborting with that policy
+
+}; // class BusFaultListener
+
+} // namespace gbtest
+
+#endif //GBTEST_BUSFAULTLISTENER_H
@@ -0,0 +1,43 @@
+#include "BusMapping.h"
+
+gbtest::BusMapping::BusMapping(BusMappingType type)
+        : type(type)
+        , provider(nullptr)
+        , readMemory(nullptr)
+        , writeMemory(nullptr)
+{
+
+}
+
+gbtest::BusMapping::BusMapping(BusProvider* provider, const uint8_t* readMemory, uint8_t* writeMemory)
+        : type(BusMappingType::Full)
+        , provider(provider)
+        , readMemory(readMemory)
+        , writeMemory(writeMemory)
+{
+
+}
+
+void gbtest::BusMapping::merge(const BusMapping& nextMapping)
+{
+    // The first provider handling the range takes precedence, the next ones only see the addresses it rejects
+    if (type == BusMappingType::Unmapped) {
+        *this = nextMapping;
+    }
+}
+
+gbtest::BusMappingType gbtest::BusMapping::getRangeMappingType(uint32_t firstAddr, uint32_t lastAddr,
+        uint32_t handledFirstAddr, uint32_t handledLastAddr)
+{
+    // Check if the range is fully handled
+    if (firstAddr >= handledFirstAddr && lastAddr <= handledLastAddr) {
+        return BusMappingType::Full;
+    }
+
+    // Check if the range overlaps the handled one
+    if (firstAddr <= handledLastAddr && lastAddr >= handledFirstAddr) {
+        return BusMappingType::Partial;
+    }
+
+    return BusMappingType::Unmapped;
+}
@@ -0,0 +1,34 @@
+#ifndef GBTEST_BUSMAPPING_H
+#define GBTEST_BUSMAPPING_H
+
+#include <cstdint>
+
+namespace gbtest {
+
+class BusProvider;
+
+enum class BusMappingType {
+    Unmapped,   // The provider doesn't handle any address of the range
+    Partial,    // The provider only handles some addresses of the range
+    Full,       // The provider handles every address of the range
+}; // enum class BusMappingType
+
+// Description of how a provider handles an address range, used by the bus to build its page table
+struct BusMapping {
+    BusMappingType type;        // How the range is handled
+    BusProvider* provider;      // Provider to send the requests of the range to (Full only)
+    const uint8_t* readMemory;  // Host memory backing reads of the range, or nullptr (Full only)
+    uint8_t* writeMemory;       // Host memory backing writes of the range, or nullptr (Full only)
+
+    explicit BusMapping(BusMappingType type = BusMappingType::Unmapped);
+    BusMapping(BusProvider* provider, const uint8_t* readMemory = nullptr, uint8_t* writeMemory = nullptr);
+
+    void merge(const BusMapping& nextMapping);
+
+    [[nodiscard]] static BusMappingType getRangeMappingType(uint32_t firstAddr, uint32_t lastAddr,
+            uint32_t handledFirstAddr, uint32_t handledLastAddr);
+}; // struct BusMapping
+
+} // namespace gbtest
+
+#endif //GBTEST_BUSMAPPING_H
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include "BusMapping.h"
 #include "BusRequestSource.h"
 
 namespace gbtest {
@@ -18,6 +19,8 @@ public:
     virtual bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const = 0;
     virtual bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) = 0;
 
+    virtual BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) = 0;
+
 }; // class BusProvider
 
 } // namespace gbtest
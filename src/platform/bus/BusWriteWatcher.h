@@ -0,0 +1,19 @@
+#ifndef GBTEST_BUSWRITEWATCHER_H
+#define GBTEST_BUSWRITEWATCHER_H
+
+#include <cstdint>
+
+namespace gbtest {
+
+class BusWriteWatcher {
+
+public:
+    virtual ~BusWriteWatcher() = default;
+
+    virtual void onWatchedWrite(uint16_t addr) = 0; // Called before the write is done
+
+}; // class BusWriteWatcher
+
+} // namespace gbtest
+
+#endif //GBTEST_BUSWRITEWATCHER_H
@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "Scheduler.h"
+
+gbtest::Scheduler::Scheduler()
+        : m_currentCycle(0)
+        , m_nextEventCycle(NoEvent)
+{
+    m_eventCycles.fill(NoEvent);
+}
+
+uint64_t gbtest::Scheduler::getCurrentCycle() const
+{
+    return m_currentCycle;
+}
+
+uint64_t* gbtest::Scheduler::getCurrentCycleData()
+{
+    return &m_currentCycle;
+}
+
+void gbtest::Scheduler::advance(uint64_t cycleCount)
+{
+    m_currentCycle += cycleCount;
+}
+
+void gbtest::Scheduler::schedule(SchedulerEventType eventType, uint64_t cycle)
+{
+    m_eventCycles[static_cast<size_t>(eventType)] = cycle;
+    updateNextEventCycle();
+}
+
+void gbtest::Scheduler::cancel(SchedulerEventType eventType)
+{
+    schedule(eventType, NoEvent);
+}
+
+uint64_t gbtest::Scheduler::getEventCycle(SchedulerEventType eventType) const
+{
+    return m_eventCycles[static_cast<size_t>(eventType)];
+}
+
+uint64_t gbtest::Scheduler::getNextEventCycle() const
+{
+    return m_nextEventCycle;
+}
+
+void gbtest::Scheduler::updateNextEventCycle()
+{
+    // There is a single slot per event type, so a linear scan is cheaper than maintaining a heap
+    m_nextEventCycle = *std::min_element(m_eventCycles.begin(), m_eventCycles.end());
+}
+
+void gbtest::Scheduler::saveState(StateWriter& writer) const
+{
+    writer.write(m_currentCycle);
+    writer.write(m_eventCycles);
+    writer.write(m_nextEventCycle);
+}
+
+void gbtest::Scheduler::loadState(StateReader& reader)
+{
+    reader.read(m_currentCycle);
+    reader.read(m_eventCycles);
+    reader.read(m_nextEventCycle);
+}
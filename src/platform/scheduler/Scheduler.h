@@ -0,0 +1,47 @@
+#ifndef GBTEST_SCHEDULER_H
+#define GBTEST_SCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "SchedulerEventType.h"
+
+#include "../state/StateReader.h"
+#include "../state/StateWriter.h"
+
+namespace gbtest {
+
+class Scheduler {
+
+public:
+    static constexpr uint64_t NoEvent = UINT64_MAX;
+
+public:
+    Scheduler();
+
+    [[nodiscard]] uint64_t getCurrentCycle() const;
+    [[nodiscard]] uint64_t* getCurrentCycleData(); // For the CPU block runners, which advance the current cycle themselves
+    void advance(uint64_t cycleCount);
+
+    void schedule(SchedulerEventType eventType, uint64_t cycle);
+    void cancel(SchedulerEventType eventType);
+
+    [[nodiscard]] uint64_t getEventCycle(SchedulerEventType eventType) const;
+    [[nodiscard]] uint64_t getNextEventCycle() const;
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+private:
+    uint64_t m_currentCycle;
+    std::array<uint64_t, static_cast<size_t>(SchedulerEventType::Count)> m_eventCycles;
+    uint64_t m_nextEventCycle;
+
+    void updateNextEventCycle();
+
+}; // class Scheduler
+
+} // namespace gbtest
+
+#endif //GBTEST_SCHEDULER_H
@@ -0,0 +1,15 @@
+#ifndef GBTEST_SCHEDULEREVENTTYPE_H
+#define GBTEST_SCHEDULEREVENTTYPE_H
+
+namespace gbtest {
+
+enum class SchedulerEventType {
+    PPU,    // Next PPU cycle that isn't spent waiting (mode change, OAM DMA transfer...)
+    Timer,  // Next TIMA overflow
+
+    Count,  // Number of event types (keep it last)
+}; // enum class SchedulerEventType
+
+} // namespace gbtest
+
+#endif //GBTEST_SCHEDULEREVENTTYPE_H
@@ -0,0 +1,224 @@
+#include "RewindBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Shorter runs of unchanged bytes are kept in the literals, their two lengths would cost more than the bytes
+constexpr size_t s_minUnchangedRunLength = 4;
+
+size_t countEqualBytes(const uint8_t* first, const uint8_t* second, size_t size)
+{
+    size_t count = 0;
+
+    // Skip whole words first, most of the state doesn't change
+    while (count + sizeof(uint64_t) <= size) {
+        uint64_t firstWord;
+        uint64_t secondWord;
+        std::memcpy(&firstWord, first + count, sizeof(uint64_t));
+        std::memcpy(&secondWord, second + count, sizeof(uint64_t));
+
+        if (firstWord != secondWord) { break; }
+
+        count += sizeof(uint64_t);
+    }
+
+    while (count < size && first[count] == second[count]) {
+        ++count;
+    }
+
+    return count;
+}
+
+void writeLength(std::vector<uint8_t>& output, size_t length)
+{
+    // LEB128: 7 bits per byte, the top bit tells if more bytes follow
+    while (length >= 0x80) {
+        output.push_back(static_cast<uint8_t>(length | 0x80));
+        length >>= 7;
+    }
+
+    output.push_back(static_cast<uint8_t>(length));
+}
+
+size_t readLength(const uint8_t*& input)
+{
+    size_t length = 0;
+    unsigned shift = 0;
+
+    while ((*input & 0x80) != 0) {
+        length |= static_cast<size_t>(*input++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    return length | (static_cast<size_t>(*input++) << shift);
+}
+
+} // namespace
+
+gbtest::RewindBuffer::RewindBuffer(size_t capacity, size_t keyframeInterval)
+        : m_keyframeInterval(std::max<size_t>(keyframeInterval, 1))
+        , m_firstSequence(0)
+        , m_nextSequence(0)
+{
+    // Only whole groups are stored, so that a group never loses its keyframe while the ring wraps around
+    const size_t groupCount = std::max<size_t>((capacity + m_keyframeInterval - 1) / m_keyframeInterval, 1);
+    m_snapshots.resize(groupCount * m_keyframeInterval);
+}
+
+void gbtest::RewindBuffer::push(const GameBoy& gameboy)
+{
+    const uint64_t sequence = m_nextSequence;
+
+    if (isKeyframe(sequence)) {
+        // Starting a new group overwrites the oldest one
+        if (sequence >= m_snapshots.size()) {
+            m_firstSequence = std::max<uint64_t>(m_firstSequence, sequence - m_snapshots.size() + m_keyframeInterval);
+        }
+
+        gameboy.saveState(getSnapshot(sequence));
+    }
+    else {
+        gameboy.saveState(m_state);
+
+        const std::vector<uint8_t>& keyframe = getSnapshot(sequence - (sequence % m_keyframeInterval));
+
+        // A state of another size (another cartridge) can't be compared to the keyframe, start over from it
+        if (m_state.size() != keyframe.size()) {
+            clear();
+            push(gameboy);
+
+            return;
+        }
+
+        encodeDelta(keyframe, m_state, getSnapshot(sequence));
+    }
+
+    m_nextSequence = sequence + 1;
+}
+
+bool gbtest::RewindBuffer::rewind(GameBoy& gameboy, size_t snapshotCount)
+{
+    // Check that there are enough snapshots
+    if (snapshotCount == 0 || snapshotCount > getSize()) {
+        return false;
+    }
+
+    const uint64_t sequence = m_nextSequence - snapshotCount;
+    const std::vector<uint8_t>& keyframe = getSnapshot(sequence - (sequence % m_keyframeInterval));
+
+    if (isKeyframe(sequence)) {
+        (void) gameboy.loadState(keyframe);
+    }
+    else {
+        decodeDelta(keyframe, getSnapshot(sequence), m_state);
+        (void) gameboy.loadState(m_state);
+    }
+
+    // The restored snapshot is now the present, the next one pushed replaces it
+    m_nextSequence = sequence;
+
+    return true;
+}
+
+void gbtest::RewindBuffer::clear()
+{
+    // Start again from a keyframe, the buffers are kept for the next snapshots
+    m_firstSequence = 0;
+    m_nextSequence = 0;
+}
+
+size_t gbtest::RewindBuffer::getSize() const
+{
+    return m_nextSequence - m_firstSequence;
+}
+
+size_t gbtest::RewindBuffer::getCapacity() const
+{
+    return m_snapshots.size();
+}
+
+size_t gbtest::RewindBuffer::getMemoryUsage() const
+{
+    size_t memoryUsage = 0;
+
+    for (uint64_t sequence = m_firstSequence; sequence < m_nextSequence; ++sequence) {
+        memoryUsage += getSnapshot(sequence).size();
+    }
+
+    return memoryUsage;
+}
+
+bool gbtest::RewindBuffer::isKeyframe(uint64_t sequence) const
+{
+    return (sequence % m_keyframeInterval) == 0;
+}
+
+std::vector<uint8_t>& gbtest::RewindBuffer::getSnapshot(uint64_t sequence)
+{
+    return m_snapshots[sequence % m_snapshots.size()];
+}
+
+const std::vector<uint8_t>& gbtest::RewindBuffer::getSnapshot(uint64_t sequence) const
+{
+    return m_snapshots[sequence % m_snapshots.size()];
+}
+
+void gbtest::RewindBuffer::encodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& state,
+        std::vector<uint8_t>& delta)
+{
+    // Alternate runs of unchanged bytes (only their length) and literals (their length, then keyframe XOR state)
+    const size_t size = state.size();
+    size_t offset = 0;
+
+    delta.clear();
+
+    while (offset < size) {
+        const size_t unchangedLength = countEqualBytes(&keyframe[offset], &state[offset], size - offset);
+        offset += unchangedLength;
+
+        // Extend the literal up to the next run of unchanged bytes long enough to be worth it
+        const size_t literalOffset = offset;
+
+        while (offset < size) {
+            if (keyframe[offset] != state[offset]) {
+                ++offset;
+                continue;
+            }
+
+            const size_t equalLength = countEqualBytes(&keyframe[offset], &state[offset],
+                    std::min(size - offset, s_minUnchangedRunLength));
+            if (equalLength == s_minUnchangedRunLength || offset + equalLength == size) { break; }
+
+            offset += equalLength;
+        }
+
+        writeLength(delta, unchangedLength);
+        writeLength(delta, offset - literalOffset);
+
+        for (size_t i = literalOffset; i < offset; ++i) {
+            delta.push_back(keyframe[i] ^ state[i]);
+        }
+    }
+}
+
+void gbtest::RewindBuffer::decodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& delta,
+        std::vector<uint8_t>& state)
+{
+    state = keyframe;
+
+    const uint8_t* input = delta.data();
+    const uint8_t* const inputEnd = delta.data() + delta.size();
+    size_t offset = 0;
+
+    while (input < inputEnd) {
+        offset += readLength(input);
+
+        const size_t literalLength = readLength(input);
+
+        for (size_t i = 0; i < literalLength; ++i) {
+            state[offset++] ^= *input++;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef GBTEST_REWINDBUFFER_H
+#define GBTEST_REWINDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../GameBoy.h"
+
+namespace gbtest {
+
+/*
+ * Ring of the last save states of a Game Boy, to go back in time
+ * Snapshots are grouped by keyframeInterval: the first one of a group is stored whole (keyframe),
+ * the others as the run-length encoded XOR of the state with that keyframe
+ * Any snapshot is restored from its keyframe and its own delta, and the oldest group is dropped as a whole
+ * Once the ring went around once, pushing and rewinding reuse the buffers and don't allocate
+ */
+class RewindBuffer {
+
+public:
+    RewindBuffer(size_t capacity, size_t keyframeInterval);
+
+    void push(const GameBoy& gameboy);
+
+    // Go back snapshotCount snapshots: the newest of them is restored, all of them are dropped
+    bool rewind(GameBoy& gameboy, size_t snapshotCount = 1);
+
+    void clear();
+
+    [[nodiscard]] size_t getSize() const;
+    [[nodiscard]] size_t getCapacity() const;
+    [[nodiscard]] size_t getMemoryUsage() const; // Bytes taken by the stored snapshots
+
+private:
+    size_t m_keyframeInterval;
+    std::vector<std::vector<uint8_t>> m_snapshots; // Keyframes and deltas, indexed by sequence number modulo capacity
+
+    uint64_t m_firstSequence; // Oldest snapshot still stored (always a keyframe)
+    uint64_t m_nextSequence;  // Sequence number of the next pushed snapshot
+
+    std::vector<uint8_t> m_state; // Scratch state, saved to or decoded into
+
+    [[nodiscard]] bool isKeyframe(uint64_t sequence) const;
+    [[nodiscard]] std::vector<uint8_t>& getSnapshot(uint64_t sequence);
+    [[nodiscard]] const std::vector<uint8_t>& getSnapshot(uint64_t sequence) const;
+
+    static void encodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& state,
+            std::vector<uint8_t>& delta);
+    static void decodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& delta,
+            std::vector<uint8_t>& state);
+
+}; // class RewindBuffer
+
+} // namespace gbtest
+
+#endif //GBTEST_REWINDBUFFER_H
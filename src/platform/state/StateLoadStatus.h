@@ -0,0 +1,15 @@
+#ifndef GBTEST_STATELOADSTATUS_H
+#define GBTEST_STATELOADSTATUS_H
+
+namespace gbtest {
+
+enum class StateLoadStatus {
+    Success,
+    InvalidHeader,      // The data isn't a save state
+    UnsupportedVersion, // The state was saved by an incompatible version
+    SizeMismatch,       // The state is truncated, or was saved with a cartridge of another RAM size
+}; // enum class StateLoadStatus
+
+} // namespace gbtest
+
+#endif //GBTEST_STATELOADSTATUS_H
@@ -0,0 +1,37 @@
+#include "StateReader.h"
+
+#include <cstring>
+
+gbtest::StateReader::StateReader(const uint8_t* data, size_t size)
+        : m_data(data)
+        , m_remainingSize(size)
+        , m_failed(false)
+{
+
+}
+
+void gbtest::StateReader::readBytes(void* data, size_t size)
+{
+    // Check that the state is long enough
+    if (size > m_remainingSize) {
+        std::memset(data, 0, size);
+        m_remainingSize = 0;
+        m_failed = true;
+
+        return;
+    }
+
+    std::memcpy(data, m_data, size);
+    m_data += size;
+    m_remainingSize -= size;
+}
+
+size_t gbtest::StateReader::getRemainingSize() const
+{
+    return m_remainingSize;
+}
+
+bool gbtest::StateReader::hasFailed() const
+{
+    return m_failed;
+}
@@ -0,0 +1,44 @@
+#ifndef GBTEST_STATEREADER_H
+#define GBTEST_STATEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace gbtest {
+
+/*
+ * Reads back the device states written by a StateWriter, in the same order
+ * Reading past the end fills the values with zeroes and marks the reader as failed
+ */
+class StateReader {
+
+public:
+    StateReader(const uint8_t* data, size_t size);
+
+    void readBytes(void* data, size_t size);
+
+    template<typename T>
+    void read(T& value);
+
+    [[nodiscard]] size_t getRemainingSize() const;
+    [[nodiscard]] bool hasFailed() const;
+
+private:
+    const uint8_t* m_data;
+    size_t m_remainingSize;
+    bool m_failed;
+
+}; // class StateReader
+
+} // namespace gbtest
+
+template<typename T>
+void gbtest::StateReader::read(T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be loaded from raw bytes");
+
+    readBytes(&value, sizeof(T));
+}
+
+#endif //GBTEST_STATEREADER_H
@@ -0,0 +1,39 @@
+#include "StateWriter.h"
+
+gbtest::StateWriter::StateWriter()
+        : m_buffer(nullptr)
+        , m_writtenSize(0)
+{
+
+}
+
+gbtest::StateWriter::StateWriter(std::vector<uint8_t>& buffer)
+        : m_buffer(&buffer)
+        , m_writtenSize(0)
+{
+    m_buffer->clear();
+}
+
+void gbtest::StateWriter::writeBytes(const void* data, size_t size)
+{
+    if (m_buffer != nullptr) {
+        const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+        m_buffer->insert(m_buffer->end(), bytes, bytes + size);
+    }
+
+    m_writtenSize += size;
+}
+
+void gbtest::StateWriter::writeZeroes(size_t size)
+{
+    if (m_buffer != nullptr) {
+        m_buffer->insert(m_buffer->end(), size, 0x00);
+    }
+
+    m_writtenSize += size;
+}
+
+size_t gbtest::StateWriter::getWrittenSize() const
+{
+    return m_writtenSize;
+}
@@ -0,0 +1,46 @@
+#ifndef GBTEST_STATEWRITER_H
+#define GBTEST_STATEWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace gbtest {
+
+/*
+ * Appends the state of the devices to a byte buffer, in native byte order
+ * The buffer is cleared but keeps its capacity, saving into the same buffer again doesn't allocate
+ * Without a buffer, the writer only counts the bytes it would have written
+ */
+class StateWriter {
+
+public:
+    StateWriter();
+    explicit StateWriter(std::vector<uint8_t>& buffer);
+
+    void writeBytes(const void* data, size_t size);
+    void writeZeroes(size_t size);
+
+    template<typename T>
+    void write(const T& value);
+
+    [[nodiscard]] size_t getWrittenSize() const;
+
+private:
+    std::vector<uint8_t>* m_buffer;
+    size_t m_writtenSize;
+
+}; // class StateWriter
+
+} // namespace gbtest
+
+template<typename T>
+void gbtest::StateWriter::write(const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be saved as raw bytes");
+
+    writeBytes(&value, sizeof(T));
+}
+
+#endif //GBTEST_STATEWRITER_H
@@ -1,28 +1,56 @@
-#include <array>
-
 #include "ColorUtils.h"
 
-static constexpr std::array<gbtest::ColorUtils::ColorRGBA8888, 4> s_dmgPaletteColors = {
-        gbtest::ColorUtils::ColorRGBA8888(255, 255, 255), // White
-        gbtest::ColorUtils::ColorRGBA8888(170, 170, 170), // Light gray
-        gbtest::ColorUtils::ColorRGBA8888(85, 85, 85), // Dark gray
-        gbtest::ColorUtils::ColorRGBA8888(0, 0, 0), // Black
-};
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GBTEST_COLORUTILS_AVX2
+#endif
 
-gbtest::ColorUtils::ColorRGBA8888
-gbtest::ColorUtils::dmgBGPaletteIndexToRGBA8888(const MonochromePalette& dmgBgPalette, uint8_t colorIndex)
+gbtest::ColorUtils::DMGPaletteLUT::DMGPaletteLUT(const DMGShades& shades)
+        : m_shades(shades)
+        , m_colors()
 {
-    switch (colorIndex) {
-    case 0: // Index 0
-        return s_dmgPaletteColors.at(dmgBgPalette.colorIdx0);
+    setShades(shades);
+}
 
-    case 1: // Index 1
-        return s_dmgPaletteColors.at(dmgBgPalette.colorIdx1);
+void gbtest::ColorUtils::DMGPaletteLUT::setShades(const DMGShades& shades)
+{
+    m_shades = shades;
 
-    case 2: // Index 2
-        return s_dmgPaletteColors.at(dmgBgPalette.colorIdx2);
+    // Each color index picks one of the 4 shades using 2 bits of the palette register
+    for (unsigned raw = 0; raw < m_colors.size(); ++raw) {
+        for (unsigned colorIndex = 0; colorIndex < 4; ++colorIndex) {
+            m_colors[raw][colorIndex] = m_shades[(raw >> (2 * colorIndex)) & 0x3].raw;
+        }
+    }
+}
+
+const gbtest::ColorUtils::DMGShades& gbtest::ColorUtils::DMGPaletteLUT::getShades() const
+{
+    return m_shades;
+}
+
+void gbtest::ColorUtils::mapColorIndicesToRGBA8888(const PaletteColors& colors, const uint8_t* colorIndices,
+        size_t count, uint32_t* pixels)
+{
+    size_t i = 0;
+
+#if defined(GBTEST_COLORUTILS_AVX2)
+    // 8 pixels at a time: the 4 colors are repeated in both halves of the register, so the permutation is a gather
+    const __m256i colorTable = _mm256_setr_epi32(
+            static_cast<int>(colors[0]), static_cast<int>(colors[1]),
+            static_cast<int>(colors[2]), static_cast<int>(colors[3]),
+            static_cast<int>(colors[0]), static_cast<int>(colors[1]),
+            static_cast<int>(colors[2]), static_cast<int>(colors[3]));
+
+    for (; i + 8 <= count; i += 8) {
+        const __m256i indices = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&colorIndices[i])));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i]),
+                _mm256_permutevar8x32_epi32(colorTable, indices));
+    }
+#endif
 
-    default: // Index 3 or Invalid index
-        return s_dmgPaletteColors.at(dmgBgPalette.colorIdx3);
+    for (; i < count; ++i) {
+        pixels[i] = colors[colorIndices[i] & 0x3];
     }
 }
@@ -1,6 +1,8 @@
 #ifndef GBTEST_COLORUTILS_H
 #define GBTEST_COLORUTILS_H
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 #include "PPURegisters.h"
@@ -28,7 +30,40 @@ union ColorRGBA8888 {
 
 static_assert(sizeof(ColorRGBA8888) == 4, "ColorRGBA8888 structure size is incorrect");
 
-[[nodiscard]] ColorRGBA8888 dmgBGPaletteIndexToRGBA8888(const MonochromePalette& dmgBgPalette, uint8_t colorIndex);
+using DMGShades = std::array<ColorRGBA8888, 4>;      // Colors of the 4 DMG shades, from white to black
+using PaletteColors = std::array<uint32_t, 4>;      // RGBA8888 colors of the 4 color indices of a palette
+
+inline constexpr DMGShades DefaultDMGShades = {
+        ColorRGBA8888(255, 255, 255), // White
+        ColorRGBA8888(170, 170, 170), // Light gray
+        ColorRGBA8888(85, 85, 85), // Dark gray
+        ColorRGBA8888(0, 0, 0), // Black
+};
+
+/*
+ * Colors of the 4 color indices for every possible value of a DMG palette register (BGP, OBP0, OBP1)
+ * The table is only rebuilt when the shades change, so custom shades (e.g. green tint) cost nothing per pixel
+ */
+class DMGPaletteLUT {
+
+public:
+    explicit DMGPaletteLUT(const DMGShades& shades = DefaultDMGShades);
+
+    void setShades(const DMGShades& shades);
+    [[nodiscard]] const DMGShades& getShades() const;
+
+    [[nodiscard]] const PaletteColors& getColors(const MonochromePalette& palette) const
+    {
+        return m_colors[palette.raw];
+    }
+
+private:
+    DMGShades m_shades;
+    std::array<PaletteColors, 0x100> m_colors;
+
+}; // class DMGPaletteLUT
+
+void mapColorIndicesToRGBA8888(const PaletteColors& colors, const uint8_t* colorIndices, size_t count, uint32_t* pixels);
 
 } // namespace gbtest::ColorUtils
 
@@ -1,9 +1,13 @@
+#include <algorithm>
+
 #include "PPU.h"
 
 #include "modes/PPUModeType.h"
 
 gbtest::PPU::PPU(Bus& bus)
-        : m_modeManager(bus, m_framebuffer, m_ppuRegisters, m_oam, m_vram)
+        : m_bus(bus)
+        , m_synchronizedCycle(0)
+        , m_modeManager(bus, m_framebuffer, m_ppuRegisters, m_oam, m_vram, m_paletteLut)
         , m_ppuRegisters()
         , m_oamDma(bus, m_oam)
 {
@@ -70,6 +74,16 @@ const gbtest::Framebuffer& gbtest::PPU::getFramebuffer() const
     return m_framebuffer;
 }
 
+gbtest::ColorUtils::DMGPaletteLUT& gbtest::PPU::getPaletteLut()
+{
+    return m_paletteLut;
+}
+
+const gbtest::ColorUtils::DMGPaletteLUT& gbtest::PPU::getPaletteLut() const
+{
+    return m_paletteLut;
+}
+
 void gbtest::PPU::reset()
 {
     m_modeManager.reset();
@@ -77,7 +91,10 @@ void gbtest::PPU::reset()
 
 bool gbtest::PPU::busRead(uint16_t addr, uint8_t& val, gbtest::BusRequestSource requestSource) const
 {
-    // Check if it's for one of our registers
+    /*
+     * Check if it's for one of our registers
+     * Reads don't need to synchronize the PPU: the cycles it has yet to run are idle, they don't change the registers
+     */
     switch (addr) {
     case 0xFF40: // [LCDC] LCD Control
         val = m_ppuRegisters.lcdControl.raw;
@@ -138,6 +155,110 @@ bool gbtest::PPU::busRead(uint16_t addr, uint8_t& val, gbtest::BusRequestSource
 bool gbtest::PPU::busWrite(uint16_t addr, uint8_t val, gbtest::BusRequestSource requestSource)
 {
     // Check if it's for one of our registers
+    if (addr >= 0xFF40 && addr <= 0xFF4B) {
+        // Writes change how the PPU runs, so catch up with the CPU first
+        synchronize(m_bus.getScheduler().getCurrentCycle());
+        writeRegister(addr, val, requestSource);
+        scheduleNextEvent();
+
+        return true;
+    }
+
+    // Dispatch the write request
+    if (m_oam.busWrite(addr, val, requestSource)) { return true; }
+    if (m_vram.busWrite(addr, val, requestSource)) { return true; }
+
+    return false;
+}
+
+bool gbtest::PPU::busReadOverride(uint16_t addr, uint8_t& val, gbtest::BusRequestSource requestSource) const
+{
+    // Prevent reads on the locked areas
+    if (isBusLocked(addr)) {
+        val = 0xFF;
+        return true;
+    }
+
+    // Dispatch the read override request
+    if (m_oam.busReadOverride(addr, val, requestSource)) { return true; }
+    if (m_oamDma.busReadOverride(addr, val, requestSource)) { return true; }
+    if (m_vram.busReadOverride(addr, val, requestSource)) { return true; }
+
+    return false;
+}
+
+bool gbtest::PPU::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusRequestSource requestSource)
+{
+    // Prevent writes on the locked areas
+    if (isBusLocked(addr)) {
+        return true;
+    }
+
+    // Dispatch the write override request
+    if (m_oam.busWriteOverride(addr, val, requestSource)) { return true; }
+    if (m_oamDma.busWriteOverride(addr, val, requestSource)) { return true; }
+    if (m_vram.busWriteOverride(addr, val, requestSource)) { return true; }
+
+    return false;
+}
+
+gbtest::BusMapping gbtest::PPU::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // Our registers are from FF40h to FF4Bh (writes to FF46h also go through us to synchronize the OAM DMA engine)
+    BusMapping busMapping;
+
+    if (firstAddr == lastAddr) {
+        if (firstAddr >= 0xFF40 && firstAddr <= 0xFF4B) {
+            busMapping = BusMapping(this);
+        }
+    }
+    else if (BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFF40, 0xFF4B) != BusMappingType::Unmapped) {
+        busMapping = BusMapping(BusMappingType::Partial);
+    }
+
+    // Merge the mappings in dispatch order
+    busMapping.merge(m_oam.getBusMapping(firstAddr, lastAddr));
+    busMapping.merge(m_oamDma.getBusMapping(firstAddr, lastAddr));
+    busMapping.merge(m_vram.getBusMapping(firstAddr, lastAddr));
+
+    return busMapping;
+}
+
+void gbtest::PPU::tick()
+{
+    // Tick the OAM DMA engine
+    m_oamDma.tick();
+
+    // Don't continue if the PPU is stopped
+    if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 0) { return; }
+
+    m_modeManager.tick();
+}
+
+void gbtest::PPU::synchronize(uint64_t cycle)
+{
+    // Catch up with the given cycle, skipping the stretches where the PPU only waits
+    while (m_synchronizedCycle < cycle) {
+        const uint64_t idleCycleCount = std::min(getIdleCycleCount(), cycle - m_synchronizedCycle);
+
+        if (idleCycleCount == 0) {
+            tick();
+            ++m_synchronizedCycle;
+        }
+        else {
+            if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1) {
+                m_modeManager.skipIdleCycles(idleCycleCount);
+            }
+
+            m_synchronizedCycle += idleCycleCount;
+        }
+    }
+
+    scheduleNextEvent();
+}
+
+void gbtest::PPU::writeRegister(uint16_t addr, uint8_t val, gbtest::BusRequestSource requestSource)
+{
     switch (addr) {
     case 0xFF40: // [LCDC] LCD Control
         if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1 && (val & 0x80) == 0x00) {
@@ -146,115 +267,135 @@ bool gbtest::PPU::busWrite(uint16_t addr, uint8_t val, gbtest::BusRequestSource
         }
 
         m_ppuRegisters.lcdControl.raw = val;
-        return true;
+
+        // VRAM and OAM locks only apply while the PPU is enabled
+        m_modeManager.updateBusLocks();
+        break;
 
     case 0xFF41: // [STAT] LCD Status
         m_ppuRegisters.lcdStatus.raw = (val & 0xF8);
-        return true;
+
+        // Update the STAT interrupt line right away, the next ticks may be skipped
+        if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1) {
+            m_modeManager.updateStatInterrupt();
+        }
+        break;
 
     case 0xFF42: // [SCY] BG Y scroll coordinate
         m_ppuRegisters.lcdPositionAndScrolling.yScroll = val;
-        return true;
+        break;
 
     case 0xFF43: // [SCX] BG X scroll coordinate
         m_ppuRegisters.lcdPositionAndScrolling.xScroll = val;
-        return true;
+        break;
 
     case 0xFF44: // [ LY] LCD Y coordinate
-        return true;
+        break;
 
     case 0xFF45: // [LYC] LY compare
         m_ppuRegisters.lcdPositionAndScrolling.lyCompare = val;
-        return true;
+        break;
+
+    case 0xFF46: // [DMA] OAM DMA source address & start
+        m_oamDma.busWrite(addr, val, requestSource);
+        break;
 
     case 0xFF47: // [ BGP] Data for the BG palette
         m_ppuRegisters.dmgPalettes.bgPaletteData.raw = val;
-        return true;
+        break;
 
     case 0xFF48: // [OBP0] Data for the first OBJ palette
         m_ppuRegisters.dmgPalettes.objectPaletteData0.raw = val;
-        return true;
+        break;
 
     case 0xFF49: // [OBP1] Data for the second OBJ palette
         m_ppuRegisters.dmgPalettes.objectPaletteData1.raw = val;
-        return true;
+        break;
 
     case 0xFF4A: // [ WY] Window Y position
         m_ppuRegisters.lcdPositionAndScrolling.yWindowPosition = val;
-        return true;
+        break;
 
     case 0xFF4B: // [ WX] Window X position
         m_ppuRegisters.lcdPositionAndScrolling.xWindowPosition = val;
-        return true;
+        break;
 
     default:
         break;
     }
-
-    // Dispatch the write request
-    if (m_oam.busWrite(addr, val, requestSource)) { return true; }
-    if (m_oamDma.busWrite(addr, val, requestSource)) { return true; }
-    if (m_vram.busWrite(addr, val, requestSource)) { return true; }
-
-    return false;
 }
 
-bool gbtest::PPU::busReadOverride(uint16_t addr, uint8_t& val, gbtest::BusRequestSource requestSource) const
+bool gbtest::PPU::isBusLocked(uint16_t addr) const
 {
     PPUModeType currentMode = m_modeManager.getCurrentMode();
 
     /*
-     * Prevent reads on OAM during modes 2 and 3
-     * Prevent reads on VRAM and CGB palette registers during mode 3
+     * OAM is locked during modes 2 and 3
+     * VRAM and CGB palette registers are locked during mode 3
+     * This must stay in sync with PPUModeManager::updateBusLocks()
      */
-    if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1
+    return m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1
             && ((addr >= 0xFE00 && addr <= 0xFE9F
                     && (currentMode == PPUModeType::OAM_Search || currentMode == PPUModeType::Drawing))
                     || (((addr >= 0x8000 && addr <= 0x9FFF) || addr == 0xFF69 || addr == 0xFF6B)
-                            && currentMode == PPUModeType::Drawing))) {
-        val = 0xFF;
-        return true;
-    }
+                            && currentMode == PPUModeType::Drawing));
+}
 
-    // Dispatch the read override request
-    if (m_oam.busReadOverride(addr, val, requestSource)) { return true; }
-    if (m_oamDma.busReadOverride(addr, val, requestSource)) { return true; }
-    if (m_vram.busReadOverride(addr, val, requestSource)) { return true; }
+uint64_t gbtest::PPU::getIdleCycleCount() const
+{
+    // The OAM DMA engine transfers a byte at each tick
+    if (m_oamDma.isTransferring()) { return 0; }
 
-    return false;
+    // Nothing happens while the PPU is stopped
+    if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 0) { return Scheduler::NoEvent; }
+
+    return m_modeManager.getIdleCycleCount();
 }
 
-bool gbtest::PPU::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusRequestSource requestSource)
+unsigned gbtest::PPU::getDrawnLineCount() const
 {
-    PPUModeType currentMode = m_modeManager.getCurrentMode();
+    // Lines of the back buffer drawn in the current frame (the current line may only be partly drawn)
+    const uint8_t currentLine = m_ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate;
+
+    return (currentLine < 144) ? currentLine + 1 : 0;
+}
 
+void gbtest::PPU::scheduleNextEvent()
+{
     /*
-     * Prevent writes on OAM during modes 2 and 3
-     * Prevent writes on VRAM and CGB palette registers during mode 3
+     * The next tick that isn't idle may change something the CPU can see without reading our registers
+     * (an interrupt line, a VRAM/OAM lock, the OAM contents), so the PPU must have run it before the CPU goes past it
      */
-    if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1
-            && ((addr >= 0xFE00 && addr <= 0xFE9F
-                    && (currentMode == PPUModeType::OAM_Search || currentMode == PPUModeType::Drawing))
-                    || (((addr >= 0x8000 && addr <= 0x9FFF) || addr == 0xFF69 || addr == 0xFF6B)
-                            && currentMode == PPUModeType::Drawing))) {
-        return true;
-    }
+    const uint64_t idleCycleCount = getIdleCycleCount();
 
-    // Dispatch the write override request
-    if (m_oam.busWriteOverride(addr, val, requestSource)) { return true; }
-    if (m_oamDma.busWriteOverride(addr, val, requestSource)) { return true; }
-    if (m_vram.busWriteOverride(addr, val, requestSource)) { return true; }
-
-    return false;
+    if (idleCycleCount == Scheduler::NoEvent) {
+        m_bus.getScheduler().cancel(SchedulerEventType::PPU);
+    }
+    else {
+        m_bus.getScheduler().schedule(SchedulerEventType::PPU, m_synchronizedCycle + idleCycleCount);
+    }
 }
 
-void gbtest::PPU::tick()
+void gbtest::PPU::saveState(StateWriter& writer) const
 {
-    // Tick the OAM DMA engine
-    m_oamDma.tick();
-
-    // Don't continue if the PPU is stopped
-    if (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 0) { return; }
+    writer.write(m_synchronizedCycle);
+    writer.write(m_ppuRegisters);
+
+    m_oam.saveState(writer);
+    m_oamDma.saveState(writer);
+    m_vram.saveState(writer);
+    m_framebuffer.saveState(writer, getDrawnLineCount());
+    m_modeManager.saveState(writer);
+}
 
-    m_modeManager.tick();
-}
\ No newline at end of file
+void gbtest::PPU::loadState(StateReader& reader)
+{
+    reader.read(m_synchronizedCycle);
+    reader.read(m_ppuRegisters);
+
+    m_oam.loadState(reader);
+    m_oamDma.loadState(reader);
+    m_vram.loadState(reader);
+    m_framebuffer.loadState(reader);
+    m_modeManager.loadState(reader); // Last, the bus locks depend on the registers
+}
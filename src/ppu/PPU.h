@@ -6,10 +6,13 @@
 #include "oam/OAM.h"
 #include "oam/OAMDMA.h"
 #include "vram/VRAM.h"
+#include "ColorUtils.h"
 #include "PPURegisters.h"
 
 #include "../platform/bus/BusProvider.h"
 #include "../platform/bus/Bus.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
 #include "../utils/Tickable.h"
 
 namespace gbtest {
@@ -39,17 +42,29 @@ public:
     [[nodiscard]] Framebuffer& getFramebuffer();
     [[nodiscard]] const Framebuffer& getFramebuffer() const;
 
+    [[nodiscard]] ColorUtils::DMGPaletteLUT& getPaletteLut();
+    [[nodiscard]] const ColorUtils::DMGPaletteLUT& getPaletteLut() const;
+
     void reset();
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
     void tick() override;
+    void synchronize(uint64_t cycle);
 
 private:
+    Bus& m_bus;
+    uint64_t m_synchronizedCycle; // First cycle the PPU hasn't run yet
+
     PPUModeManager m_modeManager;
     PPURegisters m_ppuRegisters;
 
@@ -59,6 +74,14 @@ private:
     VRAM m_vram;
 
     Framebuffer m_framebuffer;
+    ColorUtils::DMGPaletteLUT m_paletteLut;
+
+    void writeRegister(uint16_t addr, uint8_t val, BusRequestSource requestSource);
+    [[nodiscard]] bool isBusLocked(uint16_t addr) const;
+
+    [[nodiscard]] uint64_t getIdleCycleCount() const;
+    [[nodiscard]] unsigned getDrawnLineCount() const;
+    void scheduleNextEvent();
 
 }; // class PPU
 
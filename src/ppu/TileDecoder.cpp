@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <array>
+
+#include "TileDecoder.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define GBTEST_TILEDECODER_SSE2
+#endif
+
+#if defined(__AVX2__)
+#define GBTEST_TILEDECODER_AVX2
+#endif
+
+#if defined(__BMI2__)
+#define GBTEST_TILEDECODER_BMI2
+#endif
+
+// Spreads the 8 bits of a byte to the 8 bytes of a word, bit 7 going to byte 0
+static constexpr std::array<uint64_t, 0x100> generateSpreadBitsLut()
+{
+    std::array<uint64_t, 0x100> lut{};
+
+    for (unsigned val = 0; val < 0x100; ++val) {
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            lut[val] |= static_cast<uint64_t>((val >> (7 - bit)) & 0x1) << (8 * bit);
+        }
+    }
+
+    return lut;
+}
+
+static constexpr std::array<uint64_t, 0x100> s_spreadBitsLut = generateSpreadBitsLut();
+
+static inline uint64_t decodeTileLineToWord(uint16_t tileLine)
+{
+    const uint8_t lowBitplane = tileLine >> 8;
+    const uint8_t highBitplane = tileLine & 0xFF;
+
+#ifdef GBTEST_TILEDECODER_BMI2
+    // Deposit each bit in its own byte (bit 0 in byte 0), then reverse the bytes to get the leftmost pixel first
+    const uint64_t word = _pdep_u64(lowBitplane, 0x0101010101010101) | _pdep_u64(highBitplane, 0x0202020202020202);
+    return __builtin_bswap64(word);
+#else
+    return s_spreadBitsLut[lowBitplane] | (s_spreadBitsLut[highBitplane] << 1);
+#endif
+}
+
+static inline void storeWord(uint64_t word, uint8_t* colorIndices)
+{
+    // Written byte by byte to stay endianness-agnostic, compilers merge it into a single store
+    for (unsigned i = 0; i < 8; ++i) {
+        colorIndices[i] = static_cast<uint8_t>(word >> (8 * i));
+    }
+}
+
+#ifdef GBTEST_TILEDECODER_SSE2
+static inline __m128i broadcastBitplanes(uint8_t bitplane1, uint8_t bitplane0)
+{
+    return _mm_set_epi64x(static_cast<int64_t>(0x0101010101010101 * bitplane1),
+            static_cast<int64_t>(0x0101010101010101 * bitplane0));
+}
+
+// Decode 2 tile lines (16 pixels) at once
+static inline void decodeTwoTileLines(const uint16_t* tileLines, uint8_t* colorIndices)
+{
+    const __m128i pixelMasks = _mm_setr_epi8(
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+
+    const __m128i lowBitplanes = broadcastBitplanes(tileLines[1] >> 8, tileLines[0] >> 8);
+    const __m128i highBitplanes = broadcastBitplanes(tileLines[1] & 0xFF, tileLines[0] & 0xFF);
+
+    // Each byte becomes FFh if its pixel bit is set, then gets masked to the bit value in the color index
+    const __m128i lowBits = _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_and_si128(lowBitplanes, pixelMasks), pixelMasks), _mm_set1_epi8(0x01));
+    const __m128i highBits = _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_and_si128(highBitplanes, pixelMasks), pixelMasks), _mm_set1_epi8(0x02));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(colorIndices), _mm_or_si128(lowBits, highBits));
+}
+#endif
+
+#ifdef GBTEST_TILEDECODER_AVX2
+static inline __m256i broadcastBitplanes(uint8_t bitplane3, uint8_t bitplane2, uint8_t bitplane1, uint8_t bitplane0)
+{
+    return _mm256_set_epi64x(static_cast<int64_t>(0x0101010101010101 * bitplane3),
+            static_cast<int64_t>(0x0101010101010101 * bitplane2),
+            static_cast<int64_t>(0x0101010101010101 * bitplane1),
+            static_cast<int64_t>(0x0101010101010101 * bitplane0));
+}
+
+// Decode 4 tile lines (32 pixels) at once, same as decodeTwoTileLines()
+static inline void decodeFourTileLines(const uint16_t* tileLines, uint8_t* colorIndices)
+{
+    const __m256i pixelMasks = _mm256_setr_epi8(
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+            (char) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+
+    const __m256i lowBitplanes = broadcastBitplanes(tileLines[3] >> 8, tileLines[2] >> 8, tileLines[1] >> 8,
+            tileLines[0] >> 8);
+    const __m256i highBitplanes = broadcastBitplanes(tileLines[3] & 0xFF, tileLines[2] & 0xFF, tileLines[1] & 0xFF,
+            tileLines[0] & 0xFF);
+
+    const __m256i lowBits = _mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_and_si256(lowBitplanes, pixelMasks), pixelMasks), _mm256_set1_epi8(0x01));
+    const __m256i highBits = _mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_and_si256(highBitplanes, pixelMasks), pixelMasks), _mm256_set1_epi8(0x02));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(colorIndices), _mm256_or_si256(lowBits, highBits));
+}
+#endif
+
+void gbtest::TileDecoder::decodeTileLine(uint16_t tileLine, uint8_t* colorIndices)
+{
+    storeWord(decodeTileLineToWord(tileLine), colorIndices);
+}
+
+void gbtest::TileDecoder::decodeTileLines(const uint16_t* tileLines, size_t tileLineCount, uint8_t* colorIndices)
+{
+    size_t i = 0;
+
+    // Decode as many tile lines as possible with the widest vectors
+#ifdef GBTEST_TILEDECODER_AVX2
+    for (; i + 4 <= tileLineCount; i += 4) {
+        decodeFourTileLines(&tileLines[i], &colorIndices[8 * i]);
+    }
+#endif
+
+#ifdef GBTEST_TILEDECODER_SSE2
+    for (; i + 2 <= tileLineCount; i += 2) {
+        decodeTwoTileLines(&tileLines[i], &colorIndices[8 * i]);
+    }
+#endif
+
+    // Decode the remaining ones one by one
+    for (; i < tileLineCount; ++i) {
+        decodeTileLine(tileLines[i], &colorIndices[8 * i]);
+    }
+}
+
+void gbtest::TileDecoder::decodeTileMapRow(const VRAM& vram, uint8_t tileMapArea, uint8_t tileDataArea, uint8_t y,
+        TileMapRow& colorIndices)
+{
+    const VRAMTileData& vramTileData = vram.getVramTileData();
+    const VRAMTileMaps& vramTileMaps = vram.getVramTileMaps();
+
+    // Copy the 32 decoded tile lines of the row (same addressing as BackgroundFetcher)
+    for (uint8_t tileX = 0; tileX < 32; ++tileX) {
+        const uint8_t tileNumber = vramTileMaps.getTileNumberFromTileMap((32 * (y / 8)) + tileX, tileMapArea);
+        const uint8_t* const tileColorIndices = (tileDataArea == 1)
+                ? vramTileData.getDecodedTileLineUsingFirstMethod(tileNumber, y % 8)
+                : vramTileData.getDecodedTileLineUsingSecondMethod(static_cast<int8_t>(tileNumber), y % 8);
+
+        std::copy_n(tileColorIndices, 8, &colorIndices[8 * tileX]);
+    }
+}
+
+const char* gbtest::TileDecoder::getImplementationName()
+{
+#if defined(GBTEST_TILEDECODER_AVX2)
+    return "AVX2";
+#elif defined(GBTEST_TILEDECODER_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
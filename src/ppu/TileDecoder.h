@@ -0,0 +1,28 @@
+#ifndef GBTEST_TILEDECODER_H
+#define GBTEST_TILEDECODER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "vram/VRAM.h"
+
+/*
+ * Decoding of 2bpp tile lines into color indices (one byte per pixel, leftmost pixel first)
+ * Tile lines use the VRAMTileData format: the low bitplane in the high byte, the high bitplane in the low byte
+ * The implementation is picked at compile time: AVX2, SSE2 and BMI2 (PDEP) when available, else a portable LUT
+ */
+namespace gbtest::TileDecoder {
+
+using TileMapRow = std::array<uint8_t, 32 * 8>;
+
+void decodeTileLine(uint16_t tileLine, uint8_t* colorIndices);
+void decodeTileLines(const uint16_t* tileLines, size_t tileLineCount, uint8_t* colorIndices);
+
+void decodeTileMapRow(const VRAM& vram, uint8_t tileMapArea, uint8_t tileDataArea, uint8_t y, TileMapRow& colorIndices);
+
+[[nodiscard]] const char* getImplementationName();
+
+} // namespace gbtest::TileDecoder
+
+#endif //GBTEST_TILEDECODER_H
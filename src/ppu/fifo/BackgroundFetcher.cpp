@@ -1,10 +1,12 @@
+#include <algorithm>
+
 #include "BackgroundFetcher.h"
 
 gbtest::BackgroundFetcher::BackgroundFetcher(const PPURegisters& ppuRegisters, const VRAM& vram,
         PixelFIFO& pixelFifo)
         : Fetcher(ppuRegisters, vram, pixelFifo)
         , m_currentTileNumber(0)
-        , m_currentTileData(0)
+        , m_currentTileColorIndices()
         , m_fetcherX(0)
         , m_scanlineBeginSkip(true)
 {
@@ -55,35 +57,30 @@ void gbtest::BackgroundFetcher::executeState()
         break;
     }
 
-    case FetcherState::FetchTileData:
-        // Emulation shortcut: Fetch both bytes during this step
-        if (m_ppuRegisters.lcdControl.bgAndWindowTileDataArea == 1) {
-            m_currentTileData = m_vram.getVramTileData().getTileLineUsingFirstMethod(m_currentTileNumber,
-                    (m_ppuRegisters.lcdPositionAndScrolling.yScroll
-                            + m_ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate) % 8);
-        }
-        else {
-            m_currentTileData = m_vram.getVramTileData().getTileLineUsingSecondMethod(
-                    static_cast<int8_t>(m_currentTileNumber),
-                    (m_ppuRegisters.lcdPositionAndScrolling.yScroll
-                            + m_ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate) % 8);
-        }
+    case FetcherState::FetchTileData: {
+        // Emulation shortcut: Fetch both bytes during this step, already decoded by the tile cache
+        const uint8_t lineNumber = (m_ppuRegisters.lcdPositionAndScrolling.yScroll
+                + m_ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate) % 8;
+        const uint8_t* colorIndices = (m_ppuRegisters.lcdControl.bgAndWindowTileDataArea == 1)
+                ? m_vram.getVramTileData().getDecodedTileLineUsingFirstMethod(m_currentTileNumber, lineNumber)
+                : m_vram.getVramTileData().getDecodedTileLineUsingSecondMethod(
+                        static_cast<int8_t>(m_currentTileNumber), lineNumber);
+
+        std::copy_n(colorIndices, m_currentTileColorIndices.size(), m_currentTileColorIndices.begin());
 
         // Continue to the next state
         m_fetcherState = FetcherState::PushFIFO;
         m_cyclesToWait = 4;
 
         break;
+    }
 
     case FetcherState::PushFIFO:
         if (m_pixelFifo.empty()) {
             // Fill the queue with the fetched pixels
-            for (uint8_t i = 8; i-- > 0;) {
-                const uint8_t lowBit = (m_currentTileData >> (8 + i)) & 0x1;
-                const uint8_t highBit = (m_currentTileData >> i) & 0x1;
-
+            for (const uint8_t colorIndex: m_currentTileColorIndices) {
                 m_pixelFifo.push(FIFOPixelData(
-                        (highBit << 1) | lowBit,
+                        colorIndex,
                         0,
                         0,
                         false));
@@ -96,3 +93,23 @@ void gbtest::BackgroundFetcher::executeState()
         break;
     }
 }
+
+void gbtest::BackgroundFetcher::saveState(StateWriter& writer) const
+{
+    Fetcher::saveState(writer);
+
+    writer.write(m_currentTileNumber);
+    writer.write(m_currentTileColorIndices);
+    writer.write(m_fetcherX);
+    writer.write(m_scanlineBeginSkip);
+}
+
+void gbtest::BackgroundFetcher::loadState(StateReader& reader)
+{
+    Fetcher::loadState(reader);
+
+    reader.read(m_currentTileNumber);
+    reader.read(m_currentTileColorIndices);
+    reader.read(m_fetcherX);
+    reader.read(m_scanlineBeginSkip);
+}
@@ -1,11 +1,15 @@
 #ifndef GBTEST_BACKGROUNDFETCHER_H
 #define GBTEST_BACKGROUNDFETCHER_H
 
+#include <array>
+
 #include "Fetcher.h"
 #include "PixelFIFO.h"
 
 #include "../PPURegisters.h"
 #include "../vram/VRAM.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -18,11 +22,14 @@ public:
 
     void beginScanline() override;
 
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
     void executeState() override;
 
 private:
     uint8_t m_currentTileNumber;
-    uint16_t m_currentTileData;
+    std::array<uint8_t, 8> m_currentTileColorIndices;
 
     uint8_t m_fetcherX;
     bool m_scanlineBeginSkip;
@@ -51,3 +51,17 @@ void gbtest::Fetcher::tick()
         --m_cyclesToWait;
     }
 }
+
+void gbtest::Fetcher::saveState(StateWriter& writer) const
+{
+    writer.write(m_fetcherState);
+    writer.write(m_paused);
+    writer.write(m_cyclesToWait);
+}
+
+void gbtest::Fetcher::loadState(StateReader& reader)
+{
+    reader.read(m_fetcherState);
+    reader.read(m_paused);
+    reader.read(m_cyclesToWait);
+}
@@ -7,6 +7,8 @@
 
 #include "../vram/VRAM.h"
 #include "../PPURegisters.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 #include "../../utils/Tickable.h"
 
 namespace gbtest {
@@ -27,6 +29,9 @@ public:
 
     virtual void executeState() = 0;
 
+    virtual void saveState(StateWriter& writer) const;
+    virtual void loadState(StateReader& reader);
+
     void tick() override;
 
 protected:
@@ -33,3 +33,15 @@ void gbtest::PixelFIFO::clear()
 {
     m_size = 0;
 }
+
+void gbtest::PixelFIFO::saveState(StateWriter& writer) const
+{
+    writer.write(m_fifo);
+    writer.write(m_size);
+}
+
+void gbtest::PixelFIFO::loadState(StateReader& reader)
+{
+    reader.read(m_fifo);
+    reader.read(m_size);
+}
@@ -2,8 +2,11 @@
 #define GBTEST_PIXELFIFO_H
 
 #include <array>
+#include <cstddef>
 
 #include "FIFOPixelData.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -18,6 +21,9 @@ public:
     [[nodiscard]] bool empty() const;
     void clear();
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
 private:
     std::array<FIFOPixelData, 8> m_fifo;
     size_t m_size;
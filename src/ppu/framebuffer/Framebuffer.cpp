@@ -1,29 +1,34 @@
 #include "Framebuffer.h"
 
+#include <algorithm>
+
 gbtest::Framebuffer::Framebuffer()
-        : m_framebuffer()
+        : m_buffers()
+        , m_backBufferIndex(0)
+        , m_readyBufferIndex(1)
+        , m_presentedBufferIndex(2)
 {
 
 }
 
 void gbtest::Framebuffer::setPixel(unsigned int x, unsigned int y, uint32_t pixel)
 {
-    m_framebuffer.at((y * 160) + x) = pixel;
+    m_buffers[m_backBufferIndex].at((y * 160) + x) = pixel;
 }
 
 uint32_t gbtest::Framebuffer::getPixel(unsigned int x, unsigned int y) const
 {
-    return m_framebuffer.at((y * 160) + x);
+    return m_buffers[m_backBufferIndex].at((y * 160) + x);
 }
 
 const gbtest::Framebuffer::FramebufferContainer& gbtest::Framebuffer::getRawBuffer() const
 {
-    return m_framebuffer;
+    return m_buffers[m_backBufferIndex];
 }
 
 gbtest::Framebuffer::FramebufferContainer& gbtest::Framebuffer::getRawBuffer()
 {
-    return m_framebuffer;
+    return m_buffers[m_backBufferIndex];
 }
 
 void gbtest::Framebuffer::setFramebufferReadyCallback(FramebufferReadyCallback&& framebufferReadyCallback)
@@ -33,7 +38,45 @@ void gbtest::Framebuffer::setFramebufferReadyCallback(FramebufferReadyCallback&&
 
 void gbtest::Framebuffer::notifyReady()
 {
+    // The callback runs on the emulation thread, before the frame is handed over
     if (m_framebufferReadyCallback) {
-        m_framebufferReadyCallback(m_framebuffer);
+        m_framebufferReadyCallback(m_buffers[m_backBufferIndex]);
     }
+
+    /*
+     * Publish the back buffer, and draw the next frame into the previously published one
+     * If it was never presented, that frame is dropped: the presentation thread only wants the newest one
+     */
+    m_backBufferIndex = m_readyBufferIndex.exchange(m_backBufferIndex | NewFrameFlag, std::memory_order_acq_rel)
+            & BufferIndexMask;
+}
+
+bool gbtest::Framebuffer::swapPresentedBuffer()
+{
+    // Keep the current frame if no new one was published since the last swap
+    if ((m_readyBufferIndex.load(std::memory_order_relaxed) & NewFrameFlag) == 0) { return false; }
+
+    m_presentedBufferIndex = m_readyBufferIndex.exchange(m_presentedBufferIndex, std::memory_order_acq_rel)
+            & BufferIndexMask;
+
+    return true;
+}
+
+const gbtest::Framebuffer::FramebufferContainer& gbtest::Framebuffer::getPresentedBuffer() const
+{
+    return m_buffers[m_presentedBufferIndex];
+}
+
+void gbtest::Framebuffer::saveState(StateWriter& writer, unsigned drawnLineCount) const
+{
+    const size_t drawnPixelCount = std::min<size_t>(drawnLineCount, 144) * 160;
+
+    // Stale lines would only make the states differ more from each other
+    writer.writeBytes(m_buffers[m_backBufferIndex].data(), drawnPixelCount * sizeof(uint32_t));
+    writer.writeZeroes((m_buffers[m_backBufferIndex].size() - drawnPixelCount) * sizeof(uint32_t));
+}
+
+void gbtest::Framebuffer::loadState(StateReader& reader)
+{
+    reader.read(m_buffers[m_backBufferIndex]);
 }
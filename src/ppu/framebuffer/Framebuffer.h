@@ -2,11 +2,21 @@
 #define GBTEST_FRAMEBUFFER_H
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
+
 namespace gbtest {
 
+/*
+ * Triple-buffered framebuffer shared by the emulation thread and the presentation thread without locks
+ * The emulation thread draws into the back buffer and publishes it at VBlank (notifyReady)
+ * The presentation thread takes the newest published frame (swapPresentedBuffer) and reads it (getPresentedBuffer)
+ * Frames are handed over by swapping buffer indices, the pixels are never copied
+ */
 class Framebuffer {
 
 public:
@@ -15,6 +25,7 @@ public:
 
     Framebuffer();
 
+    // Emulation thread
     void setPixel(unsigned x, unsigned y, uint32_t pixel);
     [[nodiscard]] uint32_t getPixel(unsigned x, unsigned y) const;
 
@@ -24,8 +35,27 @@ public:
     void setFramebufferReadyCallback(FramebufferReadyCallback&& framebufferReadyCallback);
     void notifyReady();
 
+    /*
+     * The frame being drawn is part of the state, the published ones belong to the presentation thread
+     * Lines that weren't drawn yet are saved as zeroes, they're always drawn again before the frame is published
+     */
+    void saveState(StateWriter& writer, unsigned drawnLineCount) const;
+    void loadState(StateReader& reader);
+
+    // Presentation thread
+    bool swapPresentedBuffer();
+    [[nodiscard]] const FramebufferContainer& getPresentedBuffer() const;
+
 private:
-    FramebufferContainer m_framebuffer;
+    static constexpr uint8_t BufferIndexMask = 0x3;
+    static constexpr uint8_t NewFrameFlag = 0x4;
+
+    std::array<FramebufferContainer, 3> m_buffers;
+
+    uint8_t m_backBufferIndex;                  // Owned by the emulation thread
+    std::atomic<uint8_t> m_readyBufferIndex;    // Last published frame, with NewFrameFlag until it is presented
+    uint8_t m_presentedBufferIndex;             // Owned by the presentation thread
+
     FramebufferReadyCallback m_framebufferReadyCallback;
 
 }; // class Framebuffer
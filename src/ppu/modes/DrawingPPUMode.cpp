@@ -1,12 +1,12 @@
 #include "DrawingPPUMode.h"
 
-#include "../ColorUtils.h"
-
-gbtest::DrawingPPUMode::DrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters, const VRAM& vram)
+gbtest::DrawingPPUMode::DrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters, const VRAM& vram,
+        const ColorUtils::DMGPaletteLUT& paletteLut)
         : m_backgroundFetcher(ppuRegisters, vram, m_pixelFifo)
         , m_currentXCoordinate(0)
         , m_framebuffer(framebuffer)
         , m_ppuRegisters(ppuRegisters)
+        , m_paletteLut(paletteLut)
         , m_pixelsToDiscard(0)
         , m_tickCounter(0)
 {
@@ -71,13 +71,12 @@ void gbtest::DrawingPPUMode::drawPixel()
     // Only draw the pixel to the screen if it's not to be discarded
     if (m_pixelsToDiscard == 0) {
         // Draw the pixel to the screen
-        ColorUtils::ColorRGBA8888 pixelColor = ColorUtils::dmgBGPaletteIndexToRGBA8888(
-                m_ppuRegisters.dmgPalettes.bgPaletteData,
-                backgroundPixelData.colorIndex);
+        const uint32_t pixelColor =
+                m_paletteLut.getColors(m_ppuRegisters.dmgPalettes.bgPaletteData)[backgroundPixelData.colorIndex & 0x3];
 
         // Set the pixel in the framebuffer
         m_framebuffer.setPixel(m_currentXCoordinate, m_ppuRegisters.lcdPositionAndScrolling.yLcdCoordinate,
-                pixelColor.raw);
+                pixelColor);
 
         // Go to the next pixel on the line
         ++m_currentXCoordinate;
@@ -85,4 +84,28 @@ void gbtest::DrawingPPUMode::drawPixel()
     else {
         --m_pixelsToDiscard;
     }
+}
+
+void gbtest::DrawingPPUMode::saveState(StateWriter& writer) const
+{
+    PPUMode::saveState(writer);
+
+    writer.write(m_currentXCoordinate);
+    writer.write(m_pixelsToDiscard);
+    writer.write(m_tickCounter);
+
+    m_pixelFifo.saveState(writer);
+    m_backgroundFetcher.saveState(writer);
+}
+
+void gbtest::DrawingPPUMode::loadState(StateReader& reader)
+{
+    PPUMode::loadState(reader);
+
+    reader.read(m_currentXCoordinate);
+    reader.read(m_pixelsToDiscard);
+    reader.read(m_tickCounter);
+
+    m_pixelFifo.loadState(reader);
+    m_backgroundFetcher.loadState(reader);
 }
\ No newline at end of file
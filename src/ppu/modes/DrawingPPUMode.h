@@ -11,7 +11,10 @@
 #include "../fifo/PixelFIFO.h"
 #include "../framebuffer/Framebuffer.h"
 #include "../vram/VRAM.h"
+#include "../ColorUtils.h"
 #include "../PPURegisters.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -19,7 +22,8 @@ class DrawingPPUMode
         : public PPUMode {
 
 public:
-    DrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters, const VRAM& vram);
+    DrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters, const VRAM& vram,
+            const ColorUtils::DMGPaletteLUT& paletteLut);
     ~DrawingPPUMode() override = default;
 
     [[nodiscard]] static PPUModeType getModeType();
@@ -28,6 +32,9 @@ public:
 
     void restart() override;
 
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
     void executeMode() override;
 
 private:
@@ -40,6 +47,7 @@ private:
 
     Framebuffer& m_framebuffer;
     const PPURegisters& m_ppuRegisters;
+    const ColorUtils::DMGPaletteLUT& m_paletteLut;
 
     void drawPixel();
 
@@ -39,4 +39,20 @@ void gbtest::HBlankPPUMode::executeMode()
     else {
         m_finished = true;
     }
+}
+
+void gbtest::HBlankPPUMode::saveState(StateWriter& writer) const
+{
+    PPUMode::saveState(writer);
+
+    writer.write(m_blanking);
+    writer.write(m_blankingCycleCount);
+}
+
+void gbtest::HBlankPPUMode::loadState(StateReader& reader)
+{
+    PPUMode::loadState(reader);
+
+    reader.read(m_blanking);
+    reader.read(m_blankingCycleCount);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "PPUMode.h"
 #include "PPUModeType.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -20,6 +22,9 @@ public:
 
     void restart() override;
 
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
     void executeMode() override;
 
 private:
@@ -68,3 +68,21 @@ void gbtest::OAMSearchPPUMode::checkCurrentSprite()
         ++m_spriteBufferSize;
     }
 }
+
+void gbtest::OAMSearchPPUMode::saveState(StateWriter& writer) const
+{
+    PPUMode::saveState(writer);
+
+    writer.write(m_spriteBuffer);
+    writer.write(m_spriteBufferSize);
+    writer.write(m_oamIdx);
+}
+
+void gbtest::OAMSearchPPUMode::loadState(StateReader& reader)
+{
+    PPUMode::loadState(reader);
+
+    reader.read(m_spriteBuffer);
+    reader.read(m_spriteBufferSize);
+    reader.read(m_oamIdx);
+}
@@ -8,6 +8,8 @@
 
 #include "../oam/OAM.h"
 #include "../PPURegisters.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -25,6 +27,9 @@ public:
 
     void restart() override;
 
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
     void executeMode() override;
 
 private:
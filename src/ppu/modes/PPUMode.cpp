@@ -22,6 +22,25 @@ bool gbtest::PPUMode::isFullyFinished() const
     return m_finished && m_cyclesToWait == 0;
 }
 
+unsigned gbtest::PPUMode::getIdleCycleCount() const
+{
+    /*
+     * Count the next ticks that would only decrement the cycles to wait
+     * Once the mode finished, the tick bringing the counter to 0 also ends the mode, so it isn't idle
+     */
+    if (m_finished && m_cyclesToWait > 0) {
+        return m_cyclesToWait - 1;
+    }
+
+    return m_cyclesToWait;
+}
+
+void gbtest::PPUMode::skipIdleCycles(unsigned cycleCount)
+{
+    // Same as calling tick() cycleCount times, as long as these cycles are idle
+    m_cyclesToWait -= cycleCount;
+}
+
 void gbtest::PPUMode::tick()
 {
     if (m_cyclesToWait == 0 && !m_finished) {
@@ -32,4 +51,16 @@ void gbtest::PPUMode::tick()
     if (m_cyclesToWait > 0) {
         --m_cyclesToWait;
     }
+}
+
+void gbtest::PPUMode::saveState(StateWriter& writer) const
+{
+    writer.write(m_finished);
+    writer.write(m_cyclesToWait);
+}
+
+void gbtest::PPUMode::loadState(StateReader& reader)
+{
+    reader.read(m_finished);
+    reader.read(m_cyclesToWait);
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define GBTEST_PPUMODE_H
 
 #include "PPUModeType.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 #include "../../utils/Tickable.h"
 
 namespace gbtest {
@@ -17,8 +19,14 @@ public:
     [[nodiscard]] bool isFinished() const;
     [[nodiscard]] bool isFullyFinished() const;
 
+    [[nodiscard]] unsigned getIdleCycleCount() const;
+    void skipIdleCycles(unsigned cycleCount);
+
     virtual void executeMode() = 0;
 
+    virtual void saveState(StateWriter& writer) const;
+    virtual void loadState(StateReader& reader);
+
     void tick() override;
 
 protected:
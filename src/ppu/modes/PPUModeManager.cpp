@@ -1,13 +1,20 @@
+#include <cassert>
+
 #include "PPUModeManager.h"
 
 gbtest::PPUModeManager::PPUModeManager(Bus& bus, Framebuffer& framebuffer, PPURegisters& ppuRegisters, const OAM& oam,
-        const VRAM& vram)
-        : m_drawingPpuMode(framebuffer, ppuRegisters, vram)
+        const VRAM& vram, const ColorUtils::DMGPaletteLUT& paletteLut)
+        : m_drawingPpuMode(framebuffer, ppuRegisters, vram, paletteLut)
         , m_oamSearchPpuMode(ppuRegisters, oam)
+        , m_scanlineDrawingPpuMode(framebuffer, ppuRegisters, vram, paletteLut)
         , m_currentMode(PPUModeType::OAM_Search)
+        , m_scanlineRenderingEnabled(false)
+        , m_scanlineDrawing(false)
         , m_bus(bus)
         , m_framebuffer(framebuffer)
         , m_ppuRegisters(ppuRegisters)
+        , m_oamLocked(false)
+        , m_vramLocked(false)
 {
     // Start OAM Search right away
     getCurrentModeInstance().restart();
@@ -18,6 +25,28 @@ gbtest::PPUModeType gbtest::PPUModeManager::getCurrentMode() const
     return m_currentMode;
 }
 
+void gbtest::PPUModeManager::setScanlineRenderingEnabled(bool scanlineRenderingEnabled)
+{
+    // Takes effect at the next line
+    m_scanlineRenderingEnabled = scanlineRenderingEnabled;
+}
+
+bool gbtest::PPUModeManager::isScanlineRenderingEnabled() const
+{
+    return m_scanlineRenderingEnabled;
+}
+
+unsigned gbtest::PPUModeManager::getIdleCycleCount() const
+{
+    return getCurrentModeInstance().getIdleCycleCount();
+}
+
+void gbtest::PPUModeManager::skipIdleCycles(unsigned cycleCount)
+{
+    // The STAT interrupt line can't change during idle cycles, so only the current mode needs to know
+    getCurrentModeInstance().skipIdleCycles(cycleCount);
+}
+
 void gbtest::PPUModeManager::reset()
 {
     // Go to the OAM Search mode
@@ -29,6 +58,7 @@ void gbtest::PPUModeManager::reset()
     getCurrentModeInstance().restart();
     updateLcdStatusModeRegister();
     updateStatInterrupt();
+    updateBusLocks();
 }
 
 void gbtest::PPUModeManager::tick()
@@ -42,11 +72,14 @@ void gbtest::PPUModeManager::tick()
         switch (m_currentMode) {
         case PPUModeType::OAM_Search:
             m_currentMode = PPUModeType::Drawing;
+            m_scanlineDrawing = m_scanlineRenderingEnabled;
 
             break;
 
         case PPUModeType::Drawing:
-            m_hblankPpuMode.setBlankingCycleCount(376 - m_drawingPpuMode.getTickCounter());
+            m_hblankPpuMode.setBlankingCycleCount(376 - (m_scanlineDrawing
+                    ? m_scanlineDrawingPpuMode.getDrawingCycleCount()
+                    : m_drawingPpuMode.getTickCounter()));
             m_currentMode = PPUModeType::HBlank;
 
             break;
@@ -87,6 +120,7 @@ void gbtest::PPUModeManager::tick()
 
         getCurrentModeInstance().restart();
         updateLcdStatusModeRegister();
+        updateBusLocks();
     }
 
     // Update the STAT interrupt on the bus
@@ -94,12 +128,18 @@ void gbtest::PPUModeManager::tick()
 }
 
 gbtest::PPUMode& gbtest::PPUModeManager::getCurrentModeInstance()
+{
+    return const_cast<PPUMode&>(static_cast<const PPUModeManager*>(this)->getCurrentModeInstance());
+}
+
+const gbtest::PPUMode& gbtest::PPUModeManager::getCurrentModeInstance() const
 {
     switch (m_currentMode) {
     case PPUModeType::OAM_Search:
         return m_oamSearchPpuMode;
 
     case PPUModeType::Drawing:
+        if (m_scanlineDrawing) { return m_scanlineDrawingPpuMode; }
         return m_drawingPpuMode;
 
     case PPUModeType::HBlank:
@@ -108,6 +148,10 @@ gbtest::PPUMode& gbtest::PPUModeManager::getCurrentModeInstance()
     case PPUModeType::VBlank:
         return m_vblankPpuMode;
     }
+
+    // Every mode is handled above
+    assert(false);
+    return m_oamSearchPpuMode;
 }
 
 void gbtest::PPUModeManager::updateLcdStatusModeRegister()
@@ -141,3 +185,52 @@ void gbtest::PPUModeManager::updateStatInterrupt()
                     || (lcdStatus.mode2InterruptSource && m_currentMode == PPUModeType::OAM_Search)
                     || lcdStatus.lycEqualsLy);
 }
+
+void gbtest::PPUModeManager::updateBusLocks()
+{
+    // Compute which areas are locked in the current mode (see PPU::busReadOverride)
+    const bool enabled = (m_ppuRegisters.lcdControl.lcdAndPpuEnable == 1);
+    const bool oamLocked =
+            enabled && (m_currentMode == PPUModeType::OAM_Search || m_currentMode == PPUModeType::Drawing);
+    const bool vramLocked = enabled && m_currentMode == PPUModeType::Drawing;
+
+    // Tell the bus about the locks that changed, so that its page table doesn't bypass our overrides
+    if (oamLocked != m_oamLocked) {
+        m_bus.setAddressRangeOverridden(0xFE00, 0xFE9F, oamLocked);
+        m_oamLocked = oamLocked;
+    }
+
+    if (vramLocked != m_vramLocked) {
+        m_bus.setAddressRangeOverridden(0x8000, 0x9FFF, vramLocked);
+        m_bus.setAddressRangeOverridden(0xFF69, 0xFF69, vramLocked);
+        m_bus.setAddressRangeOverridden(0xFF6B, 0xFF6B, vramLocked);
+        m_vramLocked = vramLocked;
+    }
+}
+
+void gbtest::PPUModeManager::saveState(StateWriter& writer) const
+{
+    m_drawingPpuMode.saveState(writer);
+    m_hblankPpuMode.saveState(writer);
+    m_oamSearchPpuMode.saveState(writer);
+    m_vblankPpuMode.saveState(writer);
+    m_scanlineDrawingPpuMode.saveState(writer);
+
+    writer.write(m_currentMode);
+    writer.write(m_scanlineDrawing);
+}
+
+void gbtest::PPUModeManager::loadState(StateReader& reader)
+{
+    m_drawingPpuMode.loadState(reader);
+    m_hblankPpuMode.loadState(reader);
+    m_oamSearchPpuMode.loadState(reader);
+    m_vblankPpuMode.loadState(reader);
+    m_scanlineDrawingPpuMode.loadState(reader);
+
+    reader.read(m_currentMode);
+    reader.read(m_scanlineDrawing);
+
+    // The locks aren't saved, they follow from the loaded mode and registers
+    updateBusLocks();
+}
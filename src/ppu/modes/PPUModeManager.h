@@ -4,13 +4,17 @@
 #include "DrawingPPUMode.h"
 #include "HBlankPPUMode.h"
 #include "OAMSearchPPUMode.h"
+#include "ScanlineDrawingPPUMode.h"
 #include "VBlankPPUMode.h"
 
 #include "PPUModeType.h"
 
 #include "../framebuffer/Framebuffer.h"
+#include "../ColorUtils.h"
 #include "../PPURegisters.h"
 #include "../../platform/bus/Bus.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 #include "../../utils/Tickable.h"
 
 namespace gbtest {
@@ -19,12 +23,24 @@ class PPUModeManager
         : public Tickable {
 
 public:
-    PPUModeManager(Bus& bus, Framebuffer& framebuffer, PPURegisters& ppuRegisters, const OAM& oam, const VRAM& vram);
+    PPUModeManager(Bus& bus, Framebuffer& framebuffer, PPURegisters& ppuRegisters, const OAM& oam, const VRAM& vram,
+            const ColorUtils::DMGPaletteLUT& paletteLut);
     ~PPUModeManager() override = default;
 
     [[nodiscard]] PPUModeType getCurrentMode() const;
 
+    void setScanlineRenderingEnabled(bool scanlineRenderingEnabled);
+    [[nodiscard]] bool isScanlineRenderingEnabled() const;
+
+    [[nodiscard]] unsigned getIdleCycleCount() const;
+    void skipIdleCycles(unsigned cycleCount);
+
     void reset();
+    void updateStatInterrupt();
+    void updateBusLocks();
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
 
     void tick() override;
 
@@ -33,17 +49,23 @@ private:
     HBlankPPUMode m_hblankPpuMode;
     OAMSearchPPUMode m_oamSearchPpuMode;
     VBlankPPUMode m_vblankPpuMode;
+    ScanlineDrawingPPUMode m_scanlineDrawingPpuMode;
 
     PPUModeType m_currentMode;
+    bool m_scanlineRenderingEnabled;
+    bool m_scanlineDrawing; // Which drawing mode is used for the current line
 
     Bus& m_bus;
     Framebuffer& m_framebuffer;
     PPURegisters& m_ppuRegisters;
 
+    bool m_oamLocked;
+    bool m_vramLocked;
+
     [[nodiscard]] PPUMode& getCurrentModeInstance();
+    [[nodiscard]] const PPUMode& getCurrentModeInstance() const;
 
     void updateLcdStatusModeRegister();
-    void updateStatInterrupt();
 
 }; // class PPUModeManager
 
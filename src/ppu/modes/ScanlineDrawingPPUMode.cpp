@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <array>
+
+#include "ScanlineDrawingPPUMode.h"
+
+#include "../ColorUtils.h"
+
+gbtest::ScanlineDrawingPPUMode::ScanlineDrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters,
+        const VRAM& vram, const ColorUtils::DMGPaletteLUT& paletteLut)
+        : m_waiting(true)
+        , m_drawingCycleCount(0)
+        , m_framebuffer(framebuffer)
+        , m_ppuRegisters(ppuRegisters)
+        , m_vram(vram)
+        , m_paletteLut(paletteLut)
+{
+
+}
+
+inline gbtest::PPUModeType gbtest::ScanlineDrawingPPUMode::getModeType()
+{
+    return PPUModeType::Drawing;
+}
+
+unsigned gbtest::ScanlineDrawingPPUMode::getDrawingCycleCount() const
+{
+    return m_drawingCycleCount;
+}
+
+void gbtest::ScanlineDrawingPPUMode::restart()
+{
+    PPUMode::restart();
+
+    m_waiting = true;
+
+    /*
+     * Take as long as DrawingPPUMode: the fetcher pushes its first tile after 12 cycles,
+     * then the FIFO pops a pixel at each cycle, and the first (SCX % 8) pixels are discarded
+     */
+    m_drawingCycleCount = 172 + (m_ppuRegisters.lcdPositionAndScrolling.xScroll % 8);
+}
+
+void gbtest::ScanlineDrawingPPUMode::executeMode()
+{
+    if (m_waiting) {
+        // Wait until the last cycle of the mode
+        m_cyclesToWait = (m_drawingCycleCount - 1);
+        m_waiting = false;
+    }
+    else {
+        drawScanline();
+        m_finished = true;
+    }
+}
+
+void gbtest::ScanlineDrawingPPUMode::drawScanline()
+{
+    // Background only, the same output as the FIFO path (DrawingPPUMode has no window or sprites either)
+    const LCDPositionAndScrolling& lcdPositionAndScrolling = m_ppuRegisters.lcdPositionAndScrolling;
+    const VRAMTileData& vramTileData = m_vram.getVramTileData();
+    const VRAMTileMaps& vramTileMaps = m_vram.getVramTileMaps();
+
+    // Resolve the palette once for the whole line
+    const ColorUtils::PaletteColors& colors = m_paletteLut.getColors(m_ppuRegisters.dmgPalettes.bgPaletteData);
+
+    // Find the background line to draw
+    const uint8_t y = (lcdPositionAndScrolling.yScroll + lcdPositionAndScrolling.yLcdCoordinate) & 0xFF;
+    const uint8_t tileLine = y % 8;
+
+    uint32_t* const scanline = &m_framebuffer.getRawBuffer()[lcdPositionAndScrolling.yLcdCoordinate * 160];
+
+    // Fetch the 21 decoded tile lines the line overlaps (same as BackgroundFetcher)
+    std::array<uint8_t, 21 * 8> colorIndices{};
+
+    for (uint8_t tileIdx = 0; tileIdx < 21; ++tileIdx) {
+        const size_t offset = ((32 * (y / 8)) + (((lcdPositionAndScrolling.xScroll / 8) + tileIdx) & 0x1F)) & 0x3FF;
+        const uint8_t tileNumber = m_vram.isReadBlocked()
+                ? 0xFF
+                : vramTileMaps.getTileNumberFromTileMap(offset, m_ppuRegisters.lcdControl.bgTileMapArea);
+
+        const uint8_t* const tileColorIndices = (m_ppuRegisters.lcdControl.bgAndWindowTileDataArea == 1)
+                ? vramTileData.getDecodedTileLineUsingFirstMethod(tileNumber, tileLine)
+                : vramTileData.getDecodedTileLineUsingSecondMethod(static_cast<int8_t>(tileNumber), tileLine);
+
+        std::copy_n(tileColorIndices, 8, &colorIndices[8 * tileIdx]);
+    }
+
+    // Draw the 160 pixels, starting (SCX % 8) pixels into the first tile
+    ColorUtils::mapColorIndicesToRGBA8888(colors, &colorIndices[lcdPositionAndScrolling.xScroll % 8], 160, scanline);
+}
+
+void gbtest::ScanlineDrawingPPUMode::saveState(StateWriter& writer) const
+{
+    PPUMode::saveState(writer);
+
+    writer.write(m_waiting);
+    writer.write(m_drawingCycleCount);
+}
+
+void gbtest::ScanlineDrawingPPUMode::loadState(StateReader& reader)
+{
+    PPUMode::loadState(reader);
+
+    reader.read(m_waiting);
+    reader.read(m_drawingCycleCount);
+}
@@ -0,0 +1,55 @@
+#ifndef GBTEST_SCANLINEDRAWINGPPUMODE_H
+#define GBTEST_SCANLINEDRAWINGPPUMODE_H
+
+#include "PPUMode.h"
+#include "PPUModeType.h"
+
+#include "../framebuffer/Framebuffer.h"
+#include "../vram/VRAM.h"
+#include "../ColorUtils.h"
+#include "../PPURegisters.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
+
+namespace gbtest {
+
+/*
+ * Faster alternative to DrawingPPUMode, drawing the whole scanline at once at the end of the mode
+ * It lasts as long as the FIFO version, but uses the registers as they are at the end of the mode
+ * (mid-scanline effects are not supported)
+ */
+class ScanlineDrawingPPUMode
+        : public PPUMode {
+
+public:
+    ScanlineDrawingPPUMode(Framebuffer& framebuffer, const PPURegisters& ppuRegisters, const VRAM& vram,
+            const ColorUtils::DMGPaletteLUT& paletteLut);
+    ~ScanlineDrawingPPUMode() override = default;
+
+    [[nodiscard]] static PPUModeType getModeType();
+
+    [[nodiscard]] unsigned getDrawingCycleCount() const;
+
+    void restart() override;
+
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
+    void executeMode() override;
+
+private:
+    bool m_waiting;
+    unsigned m_drawingCycleCount;
+
+    Framebuffer& m_framebuffer;
+    const PPURegisters& m_ppuRegisters;
+    const VRAM& m_vram;
+    const ColorUtils::DMGPaletteLUT& m_paletteLut;
+
+    void drawScanline();
+
+}; // class ScanlineDrawingPPUMode
+
+} // namespace gbtest
+
+#endif //GBTEST_SCANLINEDRAWINGPPUMODE_H
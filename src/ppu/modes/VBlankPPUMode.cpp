@@ -29,3 +29,17 @@ void gbtest::VBlankPPUMode::executeMode()
         m_finished = true;
     }
 }
+
+void gbtest::VBlankPPUMode::saveState(StateWriter& writer) const
+{
+    PPUMode::saveState(writer);
+
+    writer.write(m_blanking);
+}
+
+void gbtest::VBlankPPUMode::loadState(StateReader& reader)
+{
+    PPUMode::loadState(reader);
+
+    reader.read(m_blanking);
+}
@@ -5,6 +5,8 @@
 #include "PPUModeType.h"
 
 #include "../PPURegisters.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -19,6 +21,9 @@ public:
 
     void restart() override;
 
+    void saveState(StateWriter& writer) const override;
+    void loadState(StateReader& reader) override;
+
     void executeMode() override;
 
 private:
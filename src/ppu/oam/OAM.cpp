@@ -113,4 +113,26 @@ bool gbtest::OAM::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusReques
 {
     // OAM never overrides write requests
     return false;
-}
\ No newline at end of file
+}
+
+gbtest::BusMapping gbtest::OAM::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // OAM is in memory area from FE00h to FE9Fh
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFE00, 0xFE9F);
+
+    if (mappingType == BusMappingType::Full) {
+        return BusMapping(this);
+    }
+
+    return BusMapping(mappingType);
+}
+
+void gbtest::OAM::saveState(StateWriter& writer) const
+{
+    writer.write(m_oamEntries);
+}
+
+void gbtest::OAM::loadState(StateReader& reader)
+{
+    reader.read(m_oamEntries);
+}
@@ -2,9 +2,12 @@
 #define GBTEST_OAM_H
 
 #include <array>
+#include <cstddef>
 
 #include "OAMEntry.h"
 #include "../../platform/bus/BusProvider.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -22,12 +25,17 @@ public:
     [[nodiscard]] const OAMEntry& getOamEntry(size_t idx) const;
     [[nodiscard]] OAMEntry& getOamEntry(size_t idx);
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     std::array<OAMEntry, 40> m_oamEntries;
 
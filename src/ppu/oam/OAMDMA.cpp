@@ -25,6 +25,10 @@ void gbtest::OAMDMA::startTransfer(uint8_t startAddressHigh)
     m_transferring = true;
     m_currentAddressLow = 0x00;
     m_sourceAddressHigh = startAddressHigh;
+
+    // Let the bus know that requests outside of the HRAM region are now overridden
+    m_bus.setAddressRangeOverridden(0x0000, 0xFF7F, true);
+    m_bus.setAddressRangeOverridden(0xFFFF, 0xFFFF, true);
 }
 
 bool gbtest::OAMDMA::isTransferring() const
@@ -48,6 +52,9 @@ void gbtest::OAMDMA::tick()
 
     if (m_currentAddressLow > 0x9F) {
         m_transferring = false;
+
+        m_bus.setAddressRangeOverridden(0x0000, 0xFF7F, false);
+        m_bus.setAddressRangeOverridden(0xFFFF, 0xFFFF, false);
     }
 }
 
@@ -100,3 +107,37 @@ bool gbtest::OAMDMA::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusReq
 
     return false;
 }
+
+gbtest::BusMapping gbtest::OAMDMA::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // OAM DMA only uses address FF46h
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFF46, 0xFF46);
+
+    if (mappingType == BusMappingType::Full) {
+        return BusMapping(this);
+    }
+
+    return BusMapping(mappingType);
+}
+
+void gbtest::OAMDMA::saveState(StateWriter& writer) const
+{
+    writer.write(m_transferring);
+    writer.write(m_currentAddressLow);
+    writer.write(m_sourceAddressHigh);
+}
+
+void gbtest::OAMDMA::loadState(StateReader& reader)
+{
+    const bool wasTransferring = m_transferring;
+
+    reader.read(m_transferring);
+    reader.read(m_currentAddressLow);
+    reader.read(m_sourceAddressHigh);
+
+    // Only release or take the bus overrides if the transfer state changed
+    if (m_transferring != wasTransferring) {
+        m_bus.setAddressRangeOverridden(0x0000, 0xFF7F, m_transferring);
+        m_bus.setAddressRangeOverridden(0xFFFF, 0xFFFF, m_transferring);
+    }
+}
@@ -5,6 +5,8 @@
 
 #include "../../platform/bus/Bus.h"
 #include "../../platform/bus/BusProvider.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 #include "../../utils/Tickable.h"
 
 namespace gbtest {
@@ -19,6 +21,9 @@ public:
     void startTransfer(uint8_t sourceAddressHigh);
     [[nodiscard]] bool isTransferring() const;
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     void tick() override;
 
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
@@ -27,6 +32,8 @@ public:
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     bool m_transferring;
     uint8_t m_currentAddressLow;
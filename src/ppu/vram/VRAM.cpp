@@ -62,3 +62,28 @@ bool gbtest::VRAM::busWriteOverride(uint16_t addr, uint8_t val, gbtest::BusReque
 
     return false;
 }
+
+gbtest::BusMapping gbtest::VRAM::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // Merge the mappings in dispatch order
+    BusMapping busMapping = m_vramTileData.getBusMapping(firstAddr, lastAddr);
+    busMapping.merge(m_vramTileMaps.getBusMapping(firstAddr, lastAddr));
+
+    return busMapping;
+}
+
+void gbtest::VRAM::saveState(StateWriter& writer) const
+{
+    m_vramTileData.saveState(writer);
+    m_vramTileMaps.saveState(writer);
+
+    writer.write(m_readBlocked);
+}
+
+void gbtest::VRAM::loadState(StateReader& reader)
+{
+    m_vramTileData.loadState(reader);
+    m_vramTileMaps.loadState(reader);
+
+    reader.read(m_readBlocked);
+}
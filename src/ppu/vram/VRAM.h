@@ -5,6 +5,8 @@
 #include "VRAMTileMaps.h"
 
 #include "../../platform/bus/BusProvider.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -21,12 +23,17 @@ public:
     void setReadBlocked(bool readBlocked);
     [[nodiscard]] bool isReadBlocked() const;
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     VRAMTileData m_vramTileData;
     VRAMTileMaps m_vramTileMaps;
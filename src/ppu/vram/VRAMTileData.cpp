@@ -1,5 +1,15 @@
 #include "VRAMTileData.h"
 
+#include "../TileDecoder.h"
+
+gbtest::VRAMTileData::VRAMTileData()
+        : m_memory()
+        , m_decodedTiles()
+{
+    // Nothing was decoded yet
+    m_dirtyTiles.set();
+}
+
 uint16_t gbtest::VRAMTileData::getTileLineUsingFirstMethod(uint8_t tileNumber, uint8_t lineNumber) const
 {
     const size_t offset = ((16 * tileNumber) + (2 * lineNumber));
@@ -14,6 +24,18 @@ uint16_t gbtest::VRAMTileData::getTileLineUsingSecondMethod(int8_t tileNumber, u
     return (m_memory.at(offset) << 8) | m_memory.at(offset + 1);
 }
 
+const uint8_t* gbtest::VRAMTileData::getDecodedTileLineUsingFirstMethod(uint8_t tileNumber, uint8_t lineNumber) const
+{
+    // Tiles 0 to 255 from 8000h
+    return getDecodedTileLine(tileNumber, lineNumber);
+}
+
+const uint8_t* gbtest::VRAMTileData::getDecodedTileLineUsingSecondMethod(int8_t tileNumber, uint8_t lineNumber) const
+{
+    // Tiles -128 to 127 from 9000h
+    return getDecodedTileLine(256 + tileNumber, lineNumber);
+}
+
 bool gbtest::VRAMTileData::busRead(uint16_t addr, uint8_t& val, gbtest::BusRequestSource requestSource) const
 {
     // VRAM Tile Data is in memory area from 8000h to 97FFh
@@ -30,8 +52,9 @@ bool gbtest::VRAMTileData::busWrite(uint16_t addr, uint8_t val, gbtest::BusReque
     // VRAM Tile Data is in memory area from 8000h to 97FFh
     if (addr < 0x8000 || addr > 0x97FF) { return false; }
 
-    // Write to the memory
+    // Write to the memory, the tile will have to be decoded again
     m_memory[addr - 0x8000] = val;
+    m_dirtyTiles.set((addr - 0x8000) / 16);
 
     return true;
 }
@@ -47,3 +70,47 @@ bool gbtest::VRAMTileData::busWriteOverride(uint16_t addr, uint8_t val, gbtest::
     // VRAM Tile Data never overrides write requests
     return false;
 }
+
+gbtest::BusMapping gbtest::VRAMTileData::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // VRAM Tile Data is in memory area from 8000h to 97FFh
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0x8000, 0x97FF);
+
+    if (mappingType == BusMappingType::Full) {
+        // Writes must go through busWrite() to invalidate the decoded tiles
+        return BusMapping(this, &m_memory[firstAddr - 0x8000], nullptr);
+    }
+
+    return BusMapping(mappingType);
+}
+
+const uint8_t* gbtest::VRAMTileData::getDecodedTileLine(size_t tileIdx, uint8_t lineNumber) const
+{
+    // Decode the tile again if it was written to since its last use
+    if (m_dirtyTiles.test(tileIdx)) {
+        std::array<uint16_t, 8> tileLines{};
+
+        for (size_t i = 0; i < tileLines.size(); ++i) {
+            const size_t offset = (16 * tileIdx) + (2 * i);
+            tileLines[i] = (m_memory[offset] << 8) | m_memory[offset + 1];
+        }
+
+        TileDecoder::decodeTileLines(tileLines.data(), tileLines.size(), m_decodedTiles[tileIdx].data());
+        m_dirtyTiles.reset(tileIdx);
+    }
+
+    return &m_decodedTiles[tileIdx][8 * lineNumber];
+}
+
+void gbtest::VRAMTileData::saveState(StateWriter& writer) const
+{
+    writer.write(m_memory);
+}
+
+void gbtest::VRAMTileData::loadState(StateReader& reader)
+{
+    reader.read(m_memory);
+
+    // The decoded tiles are a cache, decode them again on first use
+    m_dirtyTiles.set();
+}
@@ -2,9 +2,12 @@
 #define GBTEST_VRAMTILEDATA_H
 
 #include <array>
+#include <bitset>
 #include <cstdint>
 
 #include "../../platform/bus/BusProvider.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -12,21 +15,35 @@ class VRAMTileData
         : public BusProvider {
 
 public:
-    VRAMTileData() = default;
+    VRAMTileData();
     ~VRAMTileData() override = default;
 
     [[nodiscard]] uint16_t getTileLineUsingFirstMethod(uint8_t tileNumber, uint8_t lineNumber) const;
     [[nodiscard]] uint16_t getTileLineUsingSecondMethod(int8_t tileNumber, uint8_t lineNumber) const;
 
+    [[nodiscard]] const uint8_t* getDecodedTileLineUsingFirstMethod(uint8_t tileNumber, uint8_t lineNumber) const;
+    [[nodiscard]] const uint8_t* getDecodedTileLineUsingSecondMethod(int8_t tileNumber, uint8_t lineNumber) const;
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     std::array<uint8_t, 0x1800> m_memory;
 
+    // Cache of the 384 tiles decoded to one color index per pixel, each tile is decoded again on first use after a write
+    mutable std::array<std::array<uint8_t, 8 * 8>, 384> m_decodedTiles;
+    mutable std::bitset<384> m_dirtyTiles;
+
+    [[nodiscard]] const uint8_t* getDecodedTileLine(size_t tileIdx, uint8_t lineNumber) const;
+
 }; // class VRAMTileData
 
 } // namespace gbtest
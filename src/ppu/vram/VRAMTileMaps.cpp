@@ -45,3 +45,26 @@ bool gbtest::VRAMTileMaps::busWriteOverride(uint16_t addr, uint8_t val, gbtest::
     // VRAM Tile Maps never overrides write requests
     return false;
 }
+
+gbtest::BusMapping gbtest::VRAMTileMaps::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    // VRAM Tile Maps is in memory area from 9800h to 9FFFh
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0x9800, 0x9FFF);
+
+    if (mappingType == BusMappingType::Full) {
+        uint8_t* const memory = &m_memory[firstAddr - 0x9800];
+        return BusMapping(this, memory, memory);
+    }
+
+    return BusMapping(mappingType);
+}
+
+void gbtest::VRAMTileMaps::saveState(StateWriter& writer) const
+{
+    writer.write(m_memory);
+}
+
+void gbtest::VRAMTileMaps::loadState(StateReader& reader)
+{
+    reader.read(m_memory);
+}
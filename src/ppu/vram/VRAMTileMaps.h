@@ -2,9 +2,12 @@
 #define GBTEST_VRAMTILEMAPS_H
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 #include "../../platform/bus/BusProvider.h"
+#include "../../platform/state/StateReader.h"
+#include "../../platform/state/StateWriter.h"
 
 namespace gbtest {
 
@@ -17,12 +20,17 @@ public:
 
     [[nodiscard]] uint8_t getTileNumberFromTileMap(size_t offset, uint8_t whichMap) const;
 
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
     bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
     bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
     bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
 
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
 private:
     std::array<uint8_t, 0x800> m_memory;
 
@@ -0,0 +1,214 @@
+#include "Timer.h"
+
+gbtest::Timer::Timer(Bus& bus)
+        : m_bus(bus)
+        , m_synchronizedCycle(0)
+        , m_counterOffset(0)
+        , m_timerCounter(0x00)
+        , m_timerModulo(0x00)
+        , m_timerControl(0x00)
+{
+
+}
+
+void gbtest::Timer::synchronize(uint64_t cycle)
+{
+    // Catch up with the given cycle, raising the interrupt if TIMA overflowed
+    increment(countIncrements(cycle));
+    m_synchronizedCycle = cycle;
+
+    scheduleNextEvent();
+}
+
+void gbtest::Timer::saveState(StateWriter& writer) const
+{
+    writer.write(m_synchronizedCycle);
+    writer.write(m_counterOffset);
+    writer.write(m_timerCounter);
+    writer.write(m_timerModulo);
+    writer.write(m_timerControl);
+}
+
+void gbtest::Timer::loadState(StateReader& reader)
+{
+    // The next overflow is restored with the scheduler
+    reader.read(m_synchronizedCycle);
+    reader.read(m_counterOffset);
+    reader.read(m_timerCounter);
+    reader.read(m_timerModulo);
+    reader.read(m_timerControl);
+}
+
+bool gbtest::Timer::busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    const uint64_t currentCycle = m_bus.getScheduler().getCurrentCycle();
+
+    switch (addr) {
+    case 0xFF04: // [DIV] Divider register
+        val = getCounter(currentCycle) >> 8;
+        return true;
+
+    case 0xFF05: // [TIMA] Timer counter (computed, the registers are only brought up to date on writes and overflows)
+        val = getTimerCounter(currentCycle);
+        return true;
+
+    case 0xFF06: // [TMA] Timer modulo
+        val = m_timerModulo;
+        return true;
+
+    case 0xFF07: // [TAC] Timer control
+        val = 0xF8 | m_timerControl;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool gbtest::Timer::busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    if (addr < 0xFF04 || addr > 0xFF07) {
+        return false;
+    }
+
+    const uint64_t currentCycle = m_bus.getScheduler().getCurrentCycle();
+    synchronize(currentCycle);
+
+    const bool selectedBitWasHigh = isSelectedBitHigh(currentCycle);
+
+    switch (addr) {
+    case 0xFF04: // [DIV] Divider register, any write resets the whole counter
+        m_counterOffset = static_cast<uint16_t>(0 - currentCycle);
+        break;
+
+    case 0xFF05: // [TIMA] Timer counter
+        m_timerCounter = val;
+        break;
+
+    case 0xFF06: // [TMA] Timer modulo
+        m_timerModulo = val;
+        break;
+
+    case 0xFF07: // [TAC] Timer control
+        m_timerControl = val & 0x07;
+        break;
+    }
+
+    // Resetting the counter or changing the selected bit can make it fall, which counts as an increment
+    if (selectedBitWasHigh && !isSelectedBitHigh(currentCycle)) {
+        increment(1);
+    }
+
+    scheduleNextEvent();
+
+    return true;
+}
+
+bool gbtest::Timer::busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const
+{
+    // Timer never overrides read requests
+    return false;
+}
+
+bool gbtest::Timer::busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource)
+{
+    // Timer never overrides write requests
+    return false;
+}
+
+gbtest::BusMapping gbtest::Timer::getBusMapping(uint16_t firstAddr, uint16_t lastAddr)
+{
+    const BusMappingType mappingType = BusMapping::getRangeMappingType(firstAddr, lastAddr, 0xFF04, 0xFF07);
+
+    // The registers are computed on access, they can't be backed by memory
+    if (mappingType == BusMappingType::Full) {
+        return BusMapping(this);
+    }
+
+    return BusMapping(mappingType);
+}
+
+uint16_t gbtest::Timer::getCounter(uint64_t cycle) const
+{
+    return static_cast<uint16_t>(cycle + m_counterOffset);
+}
+
+unsigned gbtest::Timer::getSelectedBitShift() const
+{
+    // 4096 Hz, 262144 Hz, 65536 Hz and 16384 Hz
+    static constexpr unsigned s_selectedBitShifts[] = {9, 3, 5, 7};
+
+    return s_selectedBitShifts[m_timerControl & 0x03];
+}
+
+bool gbtest::Timer::isSelectedBitHigh(uint64_t cycle) const
+{
+    // The enable bit gates the selected bit, disabling the timer can make it fall too
+    return (m_timerControl & 0x04) != 0 && ((getCounter(cycle) >> getSelectedBitShift()) & 0x1) != 0;
+}
+
+uint64_t gbtest::Timer::countIncrements(uint64_t cycle) const
+{
+    if ((m_timerControl & 0x04) == 0 || cycle <= m_synchronizedCycle) {
+        return 0;
+    }
+
+    // The selected bit falls each time the counter reaches a multiple of twice its weight
+    const unsigned periodShift = getSelectedBitShift() + 1;
+    const uint64_t startCounter = getCounter(m_synchronizedCycle);
+
+    return ((startCounter + (cycle - m_synchronizedCycle)) >> periodShift) - (startCounter >> periodShift);
+}
+
+uint8_t gbtest::Timer::getTimerCounter(uint64_t cycle) const
+{
+    const uint64_t incrementCount = countIncrements(cycle);
+    const unsigned incrementsToOverflow = 0x100 - m_timerCounter;
+
+    if (incrementCount < incrementsToOverflow) {
+        return m_timerCounter + incrementCount;
+    }
+
+    // Each overflow reloads TIMA with TMA
+    const unsigned overflowPeriod = 0x100 - m_timerModulo;
+
+    return m_timerModulo + ((incrementCount - incrementsToOverflow) % overflowPeriod);
+}
+
+void gbtest::Timer::increment(uint64_t incrementCount)
+{
+    if (incrementCount == 0) {
+        return;
+    }
+
+    const unsigned incrementsToOverflow = 0x100 - m_timerCounter;
+
+    if (incrementCount < incrementsToOverflow) {
+        m_timerCounter += incrementCount;
+        return;
+    }
+
+    // Reload TIMA and request the interrupt (several overflows in a row only request it once)
+    const unsigned overflowPeriod = 0x100 - m_timerModulo;
+    m_timerCounter = m_timerModulo + ((incrementCount - incrementsToOverflow) % overflowPeriod);
+
+    m_bus.setInterruptLineHigh(InterruptType::Timer, true);
+    m_bus.setInterruptLineHigh(InterruptType::Timer, false);
+}
+
+void gbtest::Timer::scheduleNextEvent()
+{
+    if ((m_timerControl & 0x04) == 0) {
+        m_bus.getScheduler().cancel(SchedulerEventType::Timer);
+        return;
+    }
+
+    // The overflow happens on the falling edge that brings TIMA from FFh to 00h
+    const unsigned periodShift = getSelectedBitShift() + 1;
+    const uint64_t startCounter = getCounter(m_synchronizedCycle);
+    const uint64_t nextEdgeCounter = ((startCounter >> periodShift) + 1) << periodShift;
+    const uint64_t overflowCounter = nextEdgeCounter + (static_cast<uint64_t>(0xFF - m_timerCounter) << periodShift);
+
+    // Like for the PPU, the event is the tick that makes it happen: the counter reaches the edge at the end of it
+    m_bus.getScheduler().schedule(SchedulerEventType::Timer, m_synchronizedCycle + (overflowCounter - startCounter) - 1);
+}
@@ -0,0 +1,62 @@
+#ifndef GBTEST_TIMER_H
+#define GBTEST_TIMER_H
+
+#include <cstdint>
+
+#include "../platform/bus/Bus.h"
+#include "../platform/bus/BusProvider.h"
+#include "../platform/state/StateReader.h"
+#include "../platform/state/StateWriter.h"
+
+namespace gbtest {
+
+/*
+ * Divider and timer registers (FF04h to FF07h)
+ * Nothing is counted cycle by cycle: the 16 bits internal counter (DIV is its upper byte) is derived from the scheduler
+ * cycle, TIMA is brought up to date when it is accessed, and only the next TIMA overflow is scheduled
+ * TIMA counts the falling edges of the counter bit selected by TAC, which gives the DIV and TAC write quirks for free
+ */
+class Timer
+        : public BusProvider {
+
+public:
+    explicit Timer(Bus& bus);
+    ~Timer() override = default;
+
+    void synchronize(uint64_t cycle);
+
+    void saveState(StateWriter& writer) const;
+    void loadState(StateReader& reader);
+
+    bool busRead(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWrite(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    bool busReadOverride(uint16_t addr, uint8_t& val, BusRequestSource requestSource) const override;
+    bool busWriteOverride(uint16_t addr, uint8_t val, BusRequestSource requestSource) override;
+
+    BusMapping getBusMapping(uint16_t firstAddr, uint16_t lastAddr) override;
+
+private:
+    Bus& m_bus;
+    uint64_t m_synchronizedCycle; // Cycle TIMA is up to date with
+
+    uint16_t m_counterOffset;   // Internal counter value minus the cycle (modulo 2^16)
+    uint8_t m_timerCounter;     // [TIMA] Timer counter
+    uint8_t m_timerModulo;      // [ TMA] Timer modulo (TIMA reload value)
+    uint8_t m_timerControl;     // [ TAC] Timer control (bit 2: enable, bits 0-1: clock select)
+
+    [[nodiscard]] uint16_t getCounter(uint64_t cycle) const;
+    [[nodiscard]] unsigned getSelectedBitShift() const;
+    [[nodiscard]] bool isSelectedBitHigh(uint64_t cycle) const;
+
+    [[nodiscard]] uint64_t countIncrements(uint64_t cycle) const;
+    [[nodiscard]] uint8_t getTimerCounter(uint64_t cycle) const;
+    void increment(uint64_t incrementCount);
+
+    void scheduleNextEvent();
+
+}; // class Timer
+
+} // namespace gbtest
+
+#endif //GBTEST_TIMER_H
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../cpu/trace/Disassembler.h"
+#include "../cpu/trace/InstructionTrace.h"
+
+static void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " <trace dump> [options]" << std::endl
+              << "  --last <n>          Only print the n newest instructions" << std::endl;
+}
+
+static void printHeader(const gbtest::InstructionTrace::DumpHeader& header)
+{
+    static constexpr const char* s_faultDescriptions[] = {"Unmapped read", "Unmapped write", "Illegal opcode"};
+
+    if (header.reason == gbtest::TraceDumpReason::Fault) {
+        printf("reason: %s at 0x%04X\n", s_faultDescriptions[std::min<size_t>(header.faultType, 2)], header.faultAddr);
+    }
+    else {
+        printf("reason: requested\n");
+    }
+
+    printf("instructions: %u\n", header.entryCount);
+    printf("last cycle: %llu\n\n", static_cast<unsigned long long>(header.lastCycle));
+}
+
+static void printEntry(const gbtest::InstructionTrace::Entry& entry, uint64_t cycle,
+        const gbtest::InstructionTrace::Entry* nextEntry)
+{
+    const uint16_t opcode = entry.stamp & gbtest::InstructionTrace::s_opcodeMask;
+    const std::string mnemonic = gbtest::Disassembler::getMnemonic(opcode);
+
+    char opcodeBytes[8];
+    if (opcode >= 0x100) {
+        snprintf(opcodeBytes, sizeof(opcodeBytes), "CB %02X", opcode & 0xFF);
+    }
+    else {
+        snprintf(opcodeBytes, sizeof(opcodeBytes), "%02X", opcode);
+    }
+
+    // F as ZNHC, with the flags that are reset as dashes
+    const char flags[] = {
+            (entry.af & 0x80) ? 'Z' : '-',
+            (entry.af & 0x40) ? 'N' : '-',
+            (entry.af & 0x20) ? 'H' : '-',
+            (entry.af & 0x10) ? 'C' : '-',
+            '\0'
+    };
+
+    printf("%14llu  %04X  %-5s  %-16s  AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X  %s",
+            static_cast<unsigned long long>(cycle), entry.pc, opcodeBytes, mnemonic.c_str(),
+            entry.af, entry.bc, entry.de, entry.hl, entry.sp, flags);
+
+    // The registers are the ones before the instruction, where it went is told by the next one
+    if (nextEntry != nullptr
+            && nextEntry->pc != static_cast<uint16_t>(entry.pc + gbtest::Disassembler::getInstructionLength(opcode))) {
+        printf("  -> %04X", nextEntry->pc);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* dumpPath = nullptr;
+    size_t lastEntryCount = SIZE_MAX;
+
+    // Parse the command line
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = (i + 1 < argc);
+
+        if (std::strcmp(argv[i], "--last") == 0 && hasValue) {
+            lastEntryCount = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argv[i][0] != '-' && dumpPath == nullptr) {
+            dumpPath = argv[i];
+        }
+        else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (dumpPath == nullptr) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream dumpFile(dumpPath, std::ios::binary);
+    gbtest::InstructionTrace::DumpHeader header{};
+    std::vector<gbtest::InstructionTrace::Entry> entries;
+
+    if (!dumpFile || !gbtest::InstructionTrace::readDump(dumpFile, header, entries)) {
+        std::cerr << "Couldn't read trace dump " << dumpPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<uint64_t> cycles = gbtest::InstructionTrace::getEntryCycles(header, entries);
+
+    printHeader(header);
+    printf("%14s  %-4s  %-5s  %-16s  %s\n", "cycle", "pc", "op", "instruction", "registers before");
+
+    for (size_t i = entries.size() - std::min(lastEntryCount, entries.size()); i < entries.size(); ++i) {
+        printEntry(entries[i], cycles[i], (i + 1 < entries.size()) ? &entries[i + 1] : nullptr);
+    }
+
+    return EXIT_SUCCESS;
+}